@@ -3,6 +3,7 @@
 #include "decompression/DecompressionEngine.h"
 #include "container/RDXWriter.h"
 #include "container/RDXReader.h"
+#include "lcm/LCMWriteQueue.h"
 #include "viewmodels/JobViewModel.h"
 #include <QDebug>
 #include <QFileInfo>
@@ -31,10 +32,18 @@ void CompressionController::compressFiles(const QStringList& filePaths, const QS
     
     rdx::core::CompressionEngine engine(lcm_, schemaRegistry_);
     
+    // LCM updates are committed in the background; writer.finalize() waits for them
+    engine.setWriteQueue(std::make_shared<rdx::core::LCMWriteQueue>(lcm_));
+    
     for (const QString& filePath : filePaths) {
         QFileInfo fileInfo(filePath);
         QString fileName = fileInfo.fileName();
         
+        if (fileInfo.isDir()) {
+            compressDirectory(writer, engine, fileInfo);
+            continue;
+        }
+        
         int jobIndex = jobViewModel_.rowCount();
         jobViewModel_.addJob(fileName, JobOperation::Compress);
         jobViewModel_.updateJobStatus(jobIndex, JobStatus::Running);
@@ -58,7 +67,55 @@ void CompressionController::compressFiles(const QStringList& filePaths, const QS
         }
     }
     
-    writer.finalize();
+    // Also throws when LCM updates failed (the archive is complete then);
+    // either way the failure gets a job row of its own
+    try {
+        writer.finalize();
+    } catch (const std::exception& e) {
+        int jobIndex = jobViewModel_.rowCount();
+        jobViewModel_.addJob(QString::fromStdString(archivePath.filename().string()), JobOperation::Compress);
+        jobViewModel_.setJobError(jobIndex, QString::fromStdString(e.what()));
+        jobViewModel_.updateJobStatus(jobIndex, JobStatus::Failed);
+    }
+}
+
+void CompressionController::compressDirectory(rdx::core::RDXWriter& writer,
+                                              rdx::core::CompressionEngine& engine,
+                                              const QFileInfo& dirInfo) {
+    // One job for the whole tree; it may hold millions of files
+    int jobIndex = jobViewModel_.rowCount();
+    jobViewModel_.addJob(dirInfo.fileName() + "/", JobOperation::Compress);
+    jobViewModel_.updateJobStatus(jobIndex, JobStatus::Running);
+    
+    try {
+        std::size_t firstEntry = writer.getEntries().size();
+        auto result = writer.addDirectory(dirInfo.absoluteFilePath().toStdString(), engine,
+                                          dirInfo.fileName().toStdString());
+        
+        qint64 originalSize = 0;
+        qint64 compressedSize = 0;
+        const auto& entries = writer.getEntries();
+        for (std::size_t i = firstEntry; i < entries.size(); ++i) {
+            originalSize += static_cast<qint64>(entries[i].originalSize);
+            compressedSize += static_cast<qint64>(entries[i].compressedStructSize + entries[i].compressedResidualSize);
+        }
+        jobViewModel_.updateJobResult(jobIndex, originalSize, compressedSize, -1);
+        
+        if (result.failures.empty()) {
+            jobViewModel_.updateJobStatus(jobIndex, JobStatus::Done);
+        } else {
+            const auto& first = result.failures.front();
+            jobViewModel_.setJobError(jobIndex, QString("%1 of %2 files failed; first: %3: %4")
+                                                    .arg(result.failures.size())
+                                                    .arg(result.failures.size() + result.filesAdded)
+                                                    .arg(QString::fromStdString(first.path.string()))
+                                                    .arg(QString::fromStdString(first.error)));
+            jobViewModel_.updateJobStatus(jobIndex, JobStatus::Failed);
+        }
+    } catch (const std::exception& e) {
+        jobViewModel_.setJobError(jobIndex, QString::fromStdString(e.what()));
+        jobViewModel_.updateJobStatus(jobIndex, JobStatus::Failed);
+    }
 }
 
 void CompressionController::decompressArchive(const QString& archivePath, const QString& outputDir) {
@@ -69,30 +126,48 @@ void CompressionController::decompressArchive(const QString& archivePath, const
         std::vector<rdx::core::RDXEntry> entries;
         reader.listEntries(entries);
         
-        rdx::core::DecompressionEngine engine(lcm_, schemaRegistry_);
+        rdx::core::DecompressionEngine engine;
+        
+        // Entry schema IDs are those of the LCM the archive was written with;
+        // report them under this LCM's IDs through the archive's catalog
+        const rdx::core::RDXCatalog& catalog = reader.getCatalog();
+        auto localSchemaId = [&](int schemaId) {
+            auto schema = catalog.schemas.find(schemaId);
+            if (schema == catalog.schemas.end()) {
+                return schemaId;  // Archive predates the catalog
+            }
+            return schemaRegistry_.getSchemaId(schema->second.name, schema->second.version);
+        };
         
         QDir outputDirectory(outputDir);
         if (!outputDirectory.exists()) {
             outputDirectory.mkpath(".");
         }
         
+        int firstJobIndex = jobViewModel_.rowCount();
         for (const auto& entry : entries) {
-            QString fileName = QString::fromStdString(entry.fileName);
             int jobIndex = jobViewModel_.rowCount();
-            jobViewModel_.addJob(fileName, JobOperation::Decompress);
+            jobViewModel_.addJob(QString::fromStdString(entry.fileName), JobOperation::Decompress);
             jobViewModel_.updateJobStatus(jobIndex, JobStatus::Running);
+        }
+        
+        // Entries are decompressed and written on a worker pool; the job model
+        // is only touched from this thread once all workers are done
+        auto results = reader.extractMany(entries, std::filesystem::path(outputDir.toStdString()), engine);
+        
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            const auto& entry = entries[i];
+            int jobIndex = firstJobIndex + static_cast<int>(i);
             
-            try {
-                std::filesystem::path outputPath = (outputDir + "/" + fileName).toStdString();
-                reader.extractEntry(entry, outputPath, engine);
-                
+            if (results[i].success) {
                 jobViewModel_.updateJobResult(jobIndex,
                                             static_cast<qint64>(entry.originalSize),
                                             static_cast<qint64>(entry.compressedStructSize + entry.compressedResidualSize),
-                                            entry.schemaId);
+                                            localSchemaId(entry.schemaId));
                 jobViewModel_.updateJobStatus(jobIndex, JobStatus::Done);
-            } catch (const std::exception& e) {
-                jobViewModel_.setJobError(jobIndex, QString::fromStdString(e.what()));
+            } else {
+                jobViewModel_.setJobError(jobIndex, QString::fromStdString(results[i].error));
+                jobViewModel_.updateJobStatus(jobIndex, JobStatus::Failed);
             }
         }
     } catch (const std::exception& e) {
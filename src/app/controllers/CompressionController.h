@@ -9,9 +9,12 @@
 #include "schemas/SchemaRegistry.h"
 #include "viewmodels/JobViewModel.h"
 
+class QFileInfo;
+
 namespace rdx::core {
     class CompressionEngine;
     class DecompressionEngine;
+    class RDXWriter;
 }
 
 class CompressionController : public QObject {
@@ -41,6 +44,9 @@ private:
     JobViewModel& jobViewModel_;
     
     void compressFileAsync(const QString& filePath, const QString& archivePath, int jobIndex);
+    void compressDirectory(rdx::core::RDXWriter& writer,
+                           rdx::core::CompressionEngine& engine,
+                           const QFileInfo& dirInfo);
 };
 
 #endif // RDX_COMPRESSIONCONTROLLER_H
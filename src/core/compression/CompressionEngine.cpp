@@ -9,12 +9,25 @@
 #include "schemas/parsers/ChunkedBinaryParser.h"
 #include "util/HashUtils.h"
 #include "util/TimeUtils.h"
+#include "lcm/LCMWriteQueue.h"
 #include <zstd.h>
 #include <fstream>
 #include <algorithm>
+#include <utility>
 
 namespace rdx::core {
 
+namespace {
+
+// Smallest window used for patch-from compression (1 MiB)
+constexpr int PATCH_MIN_WINDOW_LOG = 20;
+
+// Larger content is split into independent frames of this size so that one
+// big entry can be decompressed on several threads
+constexpr std::size_t RESIDUAL_FRAME_SIZE = 16 * 1024 * 1024;
+
+} // namespace
+
 CompressionEngine::CompressionEngine(LCMManager& lcm, SchemaRegistry& schemaRegistry)
     : lcm_(lcm)
     , schemaRegistry_(schemaRegistry) {
@@ -49,17 +62,58 @@ ISchemaParser* CompressionEngine::findParser(const DetectedFileType& fileType, s
     return nullptr;
 }
 
-void CompressionEngine::compressWithZstd(std::span<const std::byte> data, ByteBuffer& out) {
+void CompressionEngine::compressWithZstd(std::span<const std::byte> data, ByteBuffer& out,
+                                         std::span<const std::byte> patchBase) {
     std::size_t maxSize = ZSTD_compressBound(data.size());
     out.resize(maxSize);
     
-    std::size_t compressedSize = ZSTD_compress(
-        out.mutableDataPtr(),
-        maxSize,
-        data.data(),
-        data.size(),
-        3  // compression level
-    );
+    std::size_t compressedSize;
+    if (patchBase.empty() && data.size() > RESIDUAL_FRAME_SIZE) {
+        std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> cctx(ZSTD_createCCtx(), &ZSTD_freeCCtx);
+        if (!cctx) {
+            throw std::runtime_error("ZSTD compression failed: out of memory");
+        }
+        
+        // Each frame records its content size, which readers use to place it
+        compressedSize = 0;
+        for (std::size_t offset = 0; offset < data.size(); offset += RESIDUAL_FRAME_SIZE) {
+            std::span<const std::byte> frame = data.subspan(offset, std::min(RESIDUAL_FRAME_SIZE, data.size() - offset));
+            std::size_t frameSize = ZSTD_compressCCtx(cctx.get(), out.mutableDataPtr() + compressedSize,
+                                                      maxSize - compressedSize, frame.data(), frame.size(), 3);
+            if (ZSTD_isError(frameSize)) {
+                compressedSize = frameSize;
+                break;
+            }
+            compressedSize += frameSize;
+        }
+    } else if (patchBase.empty()) {
+        compressedSize = ZSTD_compress(
+            out.mutableDataPtr(),
+            maxSize,
+            data.data(),
+            data.size(),
+            3  // compression level
+        );
+    } else {
+        std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> cctx(ZSTD_createCCtx(), &ZSTD_freeCCtx);
+        if (!cctx) {
+            throw std::runtime_error("ZSTD compression failed: out of memory");
+        }
+        
+        // The window has to reach back over the whole base for matches into it
+        int windowLog = PATCH_MIN_WINDOW_LOG;
+        while (windowLog < ZSTD_cParam_getBounds(ZSTD_c_windowLog).upperBound &&
+               (std::size_t(1) << windowLog) < patchBase.size() + data.size()) {
+            ++windowLog;
+        }
+        
+        ZSTD_CCtx_setParameter(cctx.get(), ZSTD_c_compressionLevel, 3);
+        ZSTD_CCtx_setParameter(cctx.get(), ZSTD_c_windowLog, windowLog);
+        ZSTD_CCtx_setParameter(cctx.get(), ZSTD_c_enableLongDistanceMatching, 1);
+        ZSTD_CCtx_refPrefix(cctx.get(), patchBase.data(), patchBase.size());
+        
+        compressedSize = ZSTD_compress2(cctx.get(), out.mutableDataPtr(), maxSize, data.data(), data.size());
+    }
     
     if (ZSTD_isError(compressedSize)) {
         throw std::runtime_error("ZSTD compression failed");
@@ -70,7 +124,8 @@ void CompressionEngine::compressWithZstd(std::span<const std::byte> data, ByteBu
 
 CompressionResult CompressionEngine::compressFile(const std::filesystem::path& inputPath,
                                                    ByteBuffer& outStructStream,
-                                                   ByteBuffer& outResidualStream) {
+                                                   ByteBuffer& outResidualStream,
+                                                   std::span<const std::byte> patchBase) {
     CompressionResult result;
     
     // Read file
@@ -87,6 +142,11 @@ CompressionResult CompressionEngine::compressFile(const std::filesystem::path& i
     file.close();
     
     result.originalSize = static_cast<std::int64_t>(fileSize);
+    result.contentChecksum = computeXXH64(std::span<const std::byte>(fileData.data(), fileData.size()));
+    
+    // Long zero runs (disk images, database files) are not stored at all;
+    // extraction recreates them as holes
+    result.zeroExtents = findZeroExtents(std::span<const std::byte>(fileData.data(), fileData.size()));
     
     // Detect file type
     FileTypeDetector detector;
@@ -96,6 +156,7 @@ CompressionResult CompressionEngine::compressFile(const std::filesystem::path& i
     // Register file type in LCM
     int fileTypeId = lcm_.getOrCreateFileTypeId(fileType.name, fileType.detectorSignature);
     result.fileTypeId = fileTypeId;
+    result.fileTypeName = fileType.name;
     
     // Find parser
     ISchemaParser* parser = findParser(fileType, prefix);
@@ -113,9 +174,9 @@ CompressionResult CompressionEngine::compressFile(const std::filesystem::path& i
         schemaId = schemaRegistry_.registerSchema(schema);
     }
     result.schemaId = schemaId;
-    
-    // Increment schema usage
-    lcm_.incrementSchemaUsage(schemaId);
+    result.schemaName = schema.name;
+    result.schemaVersion = schema.version;
+    result.schemaDefinition = schemaRegistry_.schemaToJSON(schema);
     
     // For now, serialize parsed representation as JSON-like structure (simplified)
     // In production, use proper encoding with arithmetic coding or similar
@@ -133,8 +194,14 @@ CompressionResult CompressionEngine::compressFile(const std::filesystem::path& i
     
     // For residual, compress the original file data (simplified - in production, 
     // extract only the parts not captured by structure)
-    if (!fileData.empty()) {
-        compressWithZstd(std::span<const std::byte>(fileData.data(), fileData.size()), outResidualStream);
+    if (!result.zeroExtents.empty()) {
+        ByteBuffer packed;
+        removeZeroExtents(std::span<const std::byte>(fileData.data(), fileData.size()), result.zeroExtents, packed);
+        if (!packed.empty()) {
+            compressWithZstd(packed.data(), outResidualStream, patchBase);
+        }
+    } else if (!fileData.empty()) {
+        compressWithZstd(std::span<const std::byte>(fileData.data(), fileData.size()), outResidualStream, patchBase);
     }
     
     result.compressedStructSize = static_cast<std::int64_t>(outStructStream.size());
@@ -157,8 +224,6 @@ CompressionResult CompressionEngine::compressFile(const std::filesystem::path& i
     fileInfo.firstSeenAt = getCurrentTimestamp();
     fileInfo.lastSeenAt = fileInfo.firstSeenAt;
     
-    int fileId = lcm_.registerFile(fileInfo);
-    
     // Record chunks (simplified - in production, chunk intelligently)
     std::vector<FileChunkInfo> chunks;
     constexpr std::size_t chunkSize = 64 * 1024;  // 64KB chunks
@@ -167,19 +232,30 @@ CompressionResult CompressionEngine::compressFile(const std::filesystem::path& i
         std::span<const std::byte> chunk(fileData.data() + offset, chunkLen);
         
         FileChunkInfo chunkInfo;
-        chunkInfo.fileId = fileId;
+        chunkInfo.fileId = 0;  // Assigned on registration
         chunkInfo.offsetBytes = static_cast<std::int64_t>(offset);
         chunkInfo.lengthBytes = static_cast<std::int64_t>(chunkLen);
         chunkInfo.chunkHash = computeSHA256(chunk);
         chunkInfo.chunkFingerprint = computeChunkFingerprint(chunk);
+        chunkInfo.simHash = computeSimHash(chunk);
         chunkInfo.schemaId = schemaId;
         chunkInfo.seenCount = 1;
         
         chunks.push_back(chunkInfo);
     }
     
-    if (!chunks.empty()) {
-        lcm_.recordChunks(chunks);
+    // File row and chunk rows go in together, in batched transactions; the
+    // schema use is counted only for a file that is recorded
+    if (writeQueue_) {
+        LCMWrite registration;
+        registration.kind = LCMWrite::Kind::RegisterFile;
+        registration.file = std::move(fileInfo);
+        registration.chunks = std::move(chunks);
+        registration.countsSchemaUse = true;
+        writeQueue_->post(std::move(registration));
+    } else {
+        lcm_.registerFileWithChunks(fileInfo, std::move(chunks));
+        lcm_.incrementSchemaUsage(schemaId);
     }
     
     return result;
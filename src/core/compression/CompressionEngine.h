@@ -5,12 +5,15 @@
 #include "schemas/SchemaRegistry.h"
 #include "schemas/parsers/ISchemaParser.h"
 #include "util/ByteBuffer.h"
+#include "util/ZeroExtents.h"
 #include <filesystem>
 #include <memory>
 #include <vector>
 
 namespace rdx::core {
 
+class LCMWriteQueue;
+
 struct CompressionResult {
     std::int64_t originalSize;
     std::int64_t compressedStructSize;
@@ -18,24 +21,44 @@ struct CompressionResult {
     int schemaId;
     int fileTypeId;
     double compressionRatio;
+    std::uint64_t contentChecksum;  // XXH64 of the original file content
+    std::vector<ZeroExtent> zeroExtents;  // Zero runs left out of the residual stream
+    
+    // Catalog records embedded in the archive for fileTypeId and schemaId
+    std::string fileTypeName;
+    std::string schemaName;
+    int schemaVersion;
+    std::string schemaDefinition;
 };
 
 class CompressionEngine {
 public:
     CompressionEngine(LCMManager& lcm, SchemaRegistry& schemaRegistry);
     
+    // With a non-empty `patchBase` (typically the previous version of the
+    // file), the residual is compressed against it like `zstd --patch-from`
+    // and can only be decompressed with the same base
     CompressionResult compressFile(const std::filesystem::path& inputPath,
                                    ByteBuffer& outStructStream,
-                                   ByteBuffer& outResidualStream);
+                                   ByteBuffer& outResidualStream,
+                                   std::span<const std::byte> patchBase = {});
+    
+    // With a queue set, file registration, chunk records and schema usage
+    // are posted to it instead of written before compressFile returns.
+    // RDXWriter::finalize flushes the queues of the engines it was given.
+    void setWriteQueue(std::shared_ptr<LCMWriteQueue> queue) { writeQueue_ = std::move(queue); }
+    const std::shared_ptr<LCMWriteQueue>& getWriteQueue() const { return writeQueue_; }
 
 private:
     LCMManager& lcm_;
+    std::shared_ptr<LCMWriteQueue> writeQueue_;
     SchemaRegistry& schemaRegistry_;
     std::vector<std::unique_ptr<ISchemaParser>> parsers_;
     
     void initializeParsers();
     ISchemaParser* findParser(const DetectedFileType& fileType, std::span<const std::byte> prefix);
-    void compressWithZstd(std::span<const std::byte> data, ByteBuffer& out);
+    void compressWithZstd(std::span<const std::byte> data, ByteBuffer& out,
+                          std::span<const std::byte> patchBase = {});
 };
 
 } // namespace rdx::core
@@ -0,0 +1,153 @@
+#include "container/ArchiveSink.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace rdx::core {
+
+namespace {
+
+// Four 1 MiB buffers: one being filled, up to three being written
+constexpr std::size_t STAGING_BUFFER_COUNT = 4;
+constexpr std::size_t STAGING_BUFFER_SIZE = 1024 * 1024;
+
+} // namespace
+
+void ArchiveSink::writeAt(std::int64_t, std::span<const std::byte>) {
+    throw std::logic_error("Archive sink does not support seeking");
+}
+
+FileSink::FileSink(const std::filesystem::path& path, IOBackendKind backend)
+    : file_(path, FileHandle::Mode::Write)
+    , position_(0)
+    , current_(0) {
+    initBackend(backend);
+}
+
+FileSink::FileSink(const std::filesystem::path& path, std::int64_t startOffset, IOBackendKind backend)
+    : file_(path, FileHandle::Mode::ReadWrite)
+    , position_(startOffset)
+    , current_(0) {
+    initBackend(backend);
+}
+
+void FileSink::initBackend(IOBackendKind backend) {
+    staging_.resize(STAGING_BUFFER_COUNT);
+    std::vector<std::span<std::byte>> buffers;
+    for (StagingBuffer& buffer : staging_) {
+        buffer.data.resize(STAGING_BUFFER_SIZE);
+        buffers.push_back(buffer.data);
+    }
+    staging_[0].fileOffset = position_;
+    
+    io_ = createIOBackend(file_, backend, STAGING_BUFFER_COUNT);
+    // Registration is only an optimization; unregistered buffers work the same
+    registered_ = io_->registerBuffers(buffers);
+}
+
+void FileSink::write(std::span<const std::byte> data) {
+    while (!data.empty()) {
+        StagingBuffer& buffer = staging_[current_];
+        std::size_t chunk = std::min(data.size(), buffer.data.size() - buffer.used);
+        std::memcpy(buffer.data.data() + buffer.used, data.data(), chunk);
+        buffer.used += chunk;
+        position_ += static_cast<std::int64_t>(chunk);
+        data = data.subspan(chunk);
+        
+        if (buffer.used == buffer.data.size()) {
+            submitCurrent();
+            nextBuffer();
+        }
+    }
+}
+
+void FileSink::writeAt(std::int64_t offset, std::span<const std::byte> data) {
+    // Patches may touch staged bytes, so get everything onto disk first
+    drain();
+    file_.writeAt(offset, data.data(), data.size());
+}
+
+void FileSink::close() {
+    if (!file_.isOpen()) {
+        return;
+    }
+    
+    drain();
+    
+    // Drop anything left over past the new end (e.g. a longer old index)
+    if (file_.size() > position_) {
+        file_.resize(position_);
+    }
+    io_.reset();
+    file_.close();
+}
+
+void FileSink::submitCurrent() {
+    StagingBuffer& buffer = staging_[current_];
+    if (buffer.used == 0) {
+        return;
+    }
+    
+    IORequest request;
+    request.kind = IORequest::Kind::Write;
+    request.offset = buffer.fileOffset;
+    request.buffer = buffer.data.data();
+    request.length = buffer.used;
+    request.registeredBuffer = registered_ ? static_cast<int>(current_) : -1;
+    request.userData = current_;
+    
+    buffer.inFlight = true;
+    io_->submit({&request, 1});
+}
+
+void FileSink::nextBuffer() {
+    current_ = (current_ + 1) % staging_.size();
+    while (staging_[current_].inFlight) {
+        retire(1);
+    }
+    staging_[current_].used = 0;
+    staging_[current_].fileOffset = position_;
+}
+
+void FileSink::retire(std::size_t minCompletions) {
+    std::vector<IOCompletion> completions;
+    io_->waitCompletions(completions, minCompletions);
+    
+    int error = 0;
+    for (const IOCompletion& completion : completions) {
+        staging_[completion.userData].inFlight = false;
+        if (completion.error != 0 && error == 0) {
+            error = completion.error;
+        }
+    }
+    if (error != 0) {
+        throw std::runtime_error("Failed to write archive file: " + file_.path().string() +
+                                 " (" + std::strerror(error) + ")");
+    }
+}
+
+void FileSink::drain() {
+    submitCurrent();
+    while (io_->pending() > 0) {
+        retire(io_->pending());
+    }
+    staging_[current_].used = 0;
+    staging_[current_].fileOffset = position_;
+}
+
+void StreamSink::write(std::span<const std::byte> data) {
+    stream_.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!stream_) {
+        throw std::runtime_error("Failed to write archive stream");
+    }
+}
+
+void StreamSink::close() {
+    stream_.flush();
+    if (!stream_) {
+        throw std::runtime_error("Failed to flush archive stream");
+    }
+}
+
+} // namespace rdx::core
@@ -0,0 +1,106 @@
+#ifndef RDX_ARCHIVESINK_H
+#define RDX_ARCHIVESINK_H
+
+#include "util/FileHandle.h"
+#include "util/IOBackend.h"
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace rdx::core {
+
+// Destination for archive bytes. RDXWriter only ever appends through write();
+// sinks that can seek additionally allow patching bytes already written,
+// which lets the writer use the classic layout (index offset in the header).
+// Non-seekable sinks get the streaming layout with a trailing footer instead.
+class ArchiveSink {
+public:
+    virtual ~ArchiveSink() = default;
+    
+    virtual void write(std::span<const std::byte> data) = 0;
+    
+    virtual bool canSeek() const { return false; }
+    virtual void writeAt(std::int64_t offset, std::span<const std::byte> data);
+    
+    // Called once after the last write
+    virtual void close() {}
+};
+
+// Regular file; seekable. Appended data is gathered into a few staging
+// buffers that are written through an IOBackend, so with io_uring the
+// writer keeps compressing while earlier buffers are still being written.
+class FileSink : public ArchiveSink {
+public:
+    // Truncates `path`
+    explicit FileSink(const std::filesystem::path& path, IOBackendKind backend = IOBackendKind::Auto);
+    
+    // Keeps existing contents and continues writing at `startOffset`;
+    // on close the file is cut back to the end of the written data
+    FileSink(const std::filesystem::path& path, std::int64_t startOffset,
+             IOBackendKind backend = IOBackendKind::Auto);
+    
+    // Disable copy (the backend refers to file_)
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+    
+    void write(std::span<const std::byte> data) override;
+    bool canSeek() const override { return true; }
+    void writeAt(std::int64_t offset, std::span<const std::byte> data) override;
+    void close() override;
+
+private:
+    struct StagingBuffer {
+        std::vector<std::byte> data;
+        std::size_t used = 0;
+        std::int64_t fileOffset = 0;
+        bool inFlight = false;
+    };
+    
+    FileHandle file_;
+    std::int64_t position_;
+    std::vector<StagingBuffer> staging_;   // Declared before io_ so it outlives in-flight writes
+    std::unique_ptr<IOBackend> io_;
+    std::size_t current_;
+    bool registered_ = false;
+    
+    void initBackend(IOBackendKind backend);
+    void submitCurrent();
+    void nextBuffer();
+    void retire(std::size_t minCompletions);
+    void drain();
+};
+
+// Any std::ostream (pipes via stdout, socket streams, compressors, ...).
+// The stream is not owned and must outlive the sink.
+class StreamSink : public ArchiveSink {
+public:
+    explicit StreamSink(std::ostream& stream) : stream_(stream) {}
+    
+    void write(std::span<const std::byte> data) override;
+    void close() override;
+
+private:
+    std::ostream& stream_;
+};
+
+// Hands every written range to a callback, e.g. an object-store multipart uploader
+class CallbackSink : public ArchiveSink {
+public:
+    using Callback = std::function<void(std::span<const std::byte>)>;
+    
+    explicit CallbackSink(Callback callback) : callback_(std::move(callback)) {}
+    
+    void write(std::span<const std::byte> data) override { callback_(data); }
+
+private:
+    Callback callback_;
+};
+
+} // namespace rdx::core
+
+#endif // RDX_ARCHIVESINK_H
@@ -0,0 +1,91 @@
+#include "container/RDXFormat.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace rdx::core {
+
+namespace {
+
+template <typename T>
+T readField(std::span<const std::byte> data, std::size_t offset) {
+    T value;
+    std::memcpy(&value, data.data() + offset, sizeof(value));
+    return value;
+}
+
+template <typename T>
+void appendField(ByteBuffer& out, const T& value) {
+    out.append(&value, sizeof(value));
+}
+
+} // namespace
+
+ByteBuffer encodeArchiveHeader(std::uint16_t flags, std::int64_t indexOffset) {
+    ByteBuffer out(RDX_HEADER_SIZE);
+    appendField(out, RDX_MAGIC);
+    appendField(out, RDX_FORMAT_VERSION);
+    appendField(out, flags);
+    appendField(out, indexOffset);
+    return out;
+}
+
+ByteBuffer encodeArchiveFooter(std::int64_t indexOffset) {
+    ByteBuffer out(RDX_FOOTER_SIZE);
+    appendField(out, indexOffset);
+    appendField(out, RDX_FOOTER_MAGIC);
+    return out;
+}
+
+ByteBuffer encodeBlockHeader(const RDXBlockHeader& header) {
+    ByteBuffer out(RDX_BLOCK_HEADER_SIZE_V2);
+    appendField(out, RDX_BLOCK_MAGIC_V2);
+    appendField(out, RDX_BLOCK_HEADER_SIZE_V2);
+    appendField(out, header.schemaId);
+    appendField(out, header.fileTypeId);
+    appendField(out, header.originalSize);
+    appendField(out, header.compressedStructSize);
+    appendField(out, header.compressedResidualSize);
+    appendField(out, header.flags);
+    appendField(out, header.streamChecksum);
+    appendField(out, header.contentChecksum);
+    return out;
+}
+
+RDXBlockHeader decodeBlockHeader(std::span<const std::byte> data) {
+    if (data.size() < 2 * sizeof(std::uint32_t)) {
+        throw std::runtime_error("Truncated RDX block header");
+    }
+    
+    RDXBlockHeader header;
+    header.magic = readField<std::uint32_t>(data, 0);
+    header.headerSize = readField<std::uint32_t>(data, 4);
+    
+    std::uint32_t minimumSize = 0;
+    if (header.magic == RDX_BLOCK_MAGIC_V1) {
+        minimumSize = RDX_BLOCK_HEADER_SIZE_V1;
+    } else if (header.magic == RDX_BLOCK_MAGIC_V2) {
+        minimumSize = RDX_BLOCK_HEADER_SIZE_V2;
+    } else {
+        throw std::runtime_error("Invalid RDX block magic");
+    }
+    if (header.headerSize < minimumSize || header.headerSize > data.size()) {
+        throw std::runtime_error("Invalid RDX block header size");
+    }
+    
+    header.schemaId = readField<std::int32_t>(data, 8);
+    header.fileTypeId = readField<std::int32_t>(data, 12);
+    header.originalSize = readField<std::int64_t>(data, 16);
+    header.compressedStructSize = readField<std::int64_t>(data, 24);
+    header.compressedResidualSize = readField<std::int64_t>(data, 32);
+    header.flags = readField<std::uint16_t>(data, 40);
+    
+    header.hasChecksums = header.magic == RDX_BLOCK_MAGIC_V2;
+    if (header.hasChecksums) {
+        header.streamChecksum = readField<std::uint64_t>(data, 42);
+        header.contentChecksum = readField<std::uint64_t>(data, 50);
+    }
+    
+    return header;
+}
+
+} // namespace rdx::core
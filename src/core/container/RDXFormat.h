@@ -0,0 +1,62 @@
+#ifndef RDX_RDXFORMAT_H
+#define RDX_RDXFORMAT_H
+
+#include "util/ByteBuffer.h"
+#include <cstdint>
+#include <cstddef>
+#include <span>
+
+namespace rdx::core {
+
+// On-disk constants of the RDX container (see docs/RDX_FORMAT.md)
+constexpr std::uint32_t RDX_MAGIC = 0x52445801;           // "RDX" + 0x01
+constexpr std::uint16_t RDX_FORMAT_VERSION = 5;           // Version written by RDXWriter
+constexpr std::size_t RDX_HEADER_SIZE = 16;
+
+// Header flags
+constexpr std::uint16_t RDX_FLAG_STREAMING = 0x0001;      // Index offset is in the footer
+
+// Footer of streaming archives: index offset followed by magic
+constexpr std::uint32_t RDX_FOOTER_MAGIC = 0x46584452;    // "RDXF"
+constexpr std::size_t RDX_FOOTER_SIZE = 12;
+
+constexpr std::uint32_t RDX_BLOCK_MAGIC_V1 = 0x424C4B01;  // "BLK" + 0x01, no checksums
+constexpr std::uint32_t RDX_BLOCK_MAGIC_V2 = 0x424C4B02;  // "BLK" + 0x02, XXH64 checksums
+constexpr std::uint32_t RDX_BLOCK_HEADER_SIZE_V1 = 42;
+constexpr std::uint32_t RDX_BLOCK_HEADER_SIZE_V2 = 58;
+
+// Block flags
+constexpr std::uint16_t RDX_BLOCK_FLAG_ZERO_EXTENTS = 0x0001;  // Residual omits the entry's zero extents
+
+struct RDXBlockHeader {
+    std::uint32_t magic = RDX_BLOCK_MAGIC_V2;
+    std::uint32_t headerSize = RDX_BLOCK_HEADER_SIZE_V2;  // Includes magic and size fields
+    std::int32_t schemaId = 0;
+    std::int32_t fileTypeId = 0;
+    std::int64_t originalSize = 0;
+    std::int64_t compressedStructSize = 0;
+    std::int64_t compressedResidualSize = 0;
+    std::uint16_t flags = 0;
+    
+    // Present from block version 2
+    bool hasChecksums = true;
+    std::uint64_t streamChecksum = 0;   // XXH64 of struct stream followed by residual stream
+    std::uint64_t contentChecksum = 0;  // XXH64 of the reconstructed file content
+};
+
+// Serializes the archive header in the latest format version
+ByteBuffer encodeArchiveHeader(std::uint16_t flags, std::int64_t indexOffset);
+
+// Serializes the footer that ends a streaming archive
+ByteBuffer encodeArchiveFooter(std::int64_t indexOffset);
+
+// Serializes a block header in the latest block version
+ByteBuffer encodeBlockHeader(const RDXBlockHeader& header);
+
+// Parses a block header of any supported version from the start of `data`;
+// throws if the magic is unknown or `data` is shorter than the header
+RDXBlockHeader decodeBlockHeader(std::span<const std::byte> data);
+
+} // namespace rdx::core
+
+#endif // RDX_RDXFORMAT_H
@@ -0,0 +1,115 @@
+#include "container/RDXMerge.h"
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace rdx::core {
+
+namespace {
+
+// A block written to the merged archive that later entries may share
+struct WrittenBlock {
+    const RDXReader* source;
+    RDXEntry sourceEntry;
+    RDXEntry entry;  // As written
+};
+
+bool sameBytes(const ByteBuffer& a, const ByteBuffer& b) {
+    return std::ranges::equal(a.data(), b.data());
+}
+
+bool sameZeroExtents(const RDXEntry& a, const RDXEntry& b) {
+    return std::ranges::equal(a.zeroExtents, b.zeroExtents, [](const ZeroExtent& x, const ZeroExtent& y) {
+        return x.offset == y.offset && x.length == y.length;
+    });
+}
+
+} // namespace
+
+RDXMergeResult mergeArchives(const std::vector<const RDXReader*>& sources,
+                             RDXWriter& writer,
+                             const RDXMergeOptions& options) {
+    RDXMergeResult result;
+    
+    std::vector<std::vector<RDXEntry>> entries(sources.size());
+    for (std::size_t s = 0; s < sources.size(); ++s) {
+        // Delta entries have no self-contained block to copy
+        if (sources[s]->isDelta()) {
+            throw std::runtime_error("Cannot merge delta archive (base: " + sources[s]->getBasePath() + ")");
+        }
+        sources[s]->listEntries(entries[s]);
+        writer.addCatalog(sources[s]->getCatalog());
+    }
+    
+    // Position of the surviving entry for every path
+    std::unordered_map<std::string, std::pair<std::size_t, std::size_t>> latest;
+    if (options.dropSuperseded) {
+        for (std::size_t s = 0; s < entries.size(); ++s) {
+            for (std::size_t i = 0; i < entries[s].size(); ++i) {
+                latest[entries[s][i].fileName] = {s, i};
+            }
+        }
+    }
+    
+    // Blocks already written, keyed by (original size, content checksum)
+    std::map<std::pair<std::int64_t, std::uint64_t>, std::vector<WrittenBlock>> written;
+    ByteBuffer block;
+    ByteBuffer candidate;
+    
+    for (std::size_t s = 0; s < entries.size(); ++s) {
+        for (std::size_t i = 0; i < entries[s].size(); ++i) {
+            const RDXEntry& entry = entries[s][i];
+            
+            bool superseded = options.dropSuperseded && latest[entry.fileName] != std::make_pair(s, i);
+            if (superseded || (options.keep && !options.keep(entry))) {
+                ++result.entriesDropped;
+                continue;
+            }
+            
+            std::pair<std::int64_t, std::uint64_t> key;
+            bool shareable = false;
+            if (options.shareDuplicates) {
+                RDXBlockHeader header = sources[s]->readBlockHeader(entry);
+                shareable = header.hasChecksums;
+                key = {entry.originalSize, header.contentChecksum};
+            }
+            
+            sources[s]->readRawBlock(entry, block);
+            
+            // A checksum match only nominates candidates; the block is shared
+            // if it is byte-identical as well, so a collision can't merge
+            // different content
+            const RDXEntry* sharedWith = nullptr;
+            auto candidates = shareable ? written.find(key) : written.end();
+            if (candidates != written.end()) {
+                for (const WrittenBlock& existing : candidates->second) {
+                    existing.source->readRawBlock(existing.sourceEntry, candidate);
+                    if (sameZeroExtents(existing.entry, entry) && sameBytes(candidate, block)) {
+                        sharedWith = &existing.entry;
+                        break;
+                    }
+                }
+            }
+            if (sharedWith) {
+                writer.addSharedEntry(*sharedWith, entry.fileName);
+                ++result.entriesShared;
+                continue;
+            }
+            
+            writer.addRawBlock(entry, block.data());
+            ++result.entriesCopied;
+            result.bytesCopied += entry.blockSize;
+            
+            if (shareable) {
+                written[key].push_back({sources[s], entry, writer.getEntries().back()});
+            }
+        }
+    }
+    
+    return result;
+}
+
+} // namespace rdx::core
@@ -0,0 +1,49 @@
+#ifndef RDX_RDXMERGE_H
+#define RDX_RDXMERGE_H
+
+#include "container/RDXReader.h"
+#include "container/RDXWriter.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace rdx::core {
+
+struct RDXMergeOptions {
+    // Keep only the last entry for each path; later sources (and later
+    // entries within a source, e.g. re-added files) win
+    bool dropSuperseded = true;
+    
+    // Store identical content once and let further entries share that block.
+    // Blocks with the same size and content checksum are compared byte for
+    // byte and shared only if they match, so content compressed differently
+    // (another parser or zstd version) stays separate. Version 1 blocks have
+    // no content checksum and are never shared.
+    bool shareDuplicates = false;
+    
+    // Optional filter; entries for which it returns false are dropped
+    // (e.g. files deleted since the archive was written)
+    std::function<bool(const RDXEntry&)> keep;
+};
+
+struct RDXMergeResult {
+    std::size_t entriesCopied = 0;
+    std::size_t entriesShared = 0;
+    std::size_t entriesDropped = 0;
+    std::int64_t bytesCopied = 0;
+};
+
+// Copies the entries of `sources`, in order, into `writer`. Blocks are copied
+// byte for byte (validated against their stream checksum on the way), so
+// merging and compaction run at I/O speed without touching zstd. The caller
+// finalizes the writer. Merging one archive into a new file compacts it.
+// Delta archives are rejected; they depend on their base. So are sources
+// written with different LCM databases whose catalogs map an ID to
+// different records (see RDXCatalog::merge).
+RDXMergeResult mergeArchives(const std::vector<const RDXReader*>& sources,
+                             RDXWriter& writer,
+                             const RDXMergeOptions& options = {});
+
+} // namespace rdx::core
+
+#endif // RDX_RDXMERGE_H
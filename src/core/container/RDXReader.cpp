@@ -1,14 +1,148 @@
 #include "container/RDXReader.h"
 #include "decompression/DecompressionEngine.h"
+#include "util/BlockingQueue.h"
+#include "util/HashUtils.h"
+#include "util/MappedFile.h"
+#include "util/ParallelFor.h"
+#include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <thread>
 
 namespace rdx::core {
 
+namespace {
+
+// Upper bound on block header size accepted from disk
+constexpr std::uint32_t MAX_BLOCK_HEADER_SIZE = 4096;
+
+// Delta archives whose bases are deltas themselves; guards against cycles
+constexpr unsigned MAX_DELTA_CHAIN_DEPTH = 64;
+
+// Chunk in which entry streams hash the structural stream
+constexpr std::size_t ENTRY_STREAM_READ_SIZE = 256 * 1024;
+
+// Sequential decoder over an in-memory copy of the index
+class IndexCursor {
+public:
+    explicit IndexCursor(const ByteBuffer& buffer) : buffer_(buffer), pos_(0) {}
+    
+    template <typename T>
+    T read() {
+        T value;
+        readBytes(&value, sizeof(value));
+        return value;
+    }
+    
+    std::string readString() {
+        std::uint32_t length = read<std::uint32_t>();
+        if (length > buffer_.size() - pos_) {
+            throw std::runtime_error("Corrupted RDX index: unexpected end of index");
+        }
+        std::string value(length, '\0');
+        readBytes(value.data(), length);
+        return value;
+    }
+    
+    void readBytes(void* out, std::size_t size) {
+        if (size > buffer_.size() - pos_) {
+            throw std::runtime_error("Corrupted RDX index: unexpected end of index");
+        }
+        std::memcpy(out, buffer_.dataPtr() + pos_, size);
+        pos_ += size;
+    }
+
+private:
+    const ByteBuffer& buffer_;
+    std::size_t pos_;
+};
+
+// A block read in one piece, split into its header and two streams
+struct BlockView {
+    RDXBlockHeader header;
+    std::span<const std::byte> structStream;
+    std::span<const std::byte> residualStream;
+};
+
+void validateBlockHeader(const RDXEntry& entry, const RDXBlockHeader& header) {
+    if (header.originalSize != entry.originalSize ||
+        header.compressedStructSize != entry.compressedStructSize ||
+        header.compressedResidualSize != entry.compressedResidualSize) {
+        throw std::runtime_error("block header does not match index entry");
+    }
+    if (((header.flags & RDX_BLOCK_FLAG_ZERO_EXTENTS) != 0) != !entry.zeroExtents.empty()) {
+        throw std::runtime_error("block zero-extent flag does not match index entry");
+    }
+    if (header.headerSize + entry.compressedStructSize + entry.compressedResidualSize > entry.blockSize) {
+        throw std::runtime_error("block streams exceed block size");
+    }
+}
+
+// Validates the block against its index entry and the stream checksum
+BlockView splitBlock(const RDXEntry& entry, std::span<const std::byte> block) {
+    BlockView view;
+    view.header = decodeBlockHeader(block);
+    validateBlockHeader(entry, view.header);
+    
+    view.structStream = block.subspan(view.header.headerSize, static_cast<std::size_t>(entry.compressedStructSize));
+    view.residualStream = block.subspan(view.header.headerSize + view.structStream.size(),
+                                        static_cast<std::size_t>(entry.compressedResidualSize));
+    
+    if (view.header.hasChecksums) {
+        XXH64State streamHash;
+        streamHash.update(view.structStream);
+        streamHash.update(view.residualStream);
+        if (streamHash.digest() != view.header.streamChecksum) {
+            throw std::runtime_error("stream checksum mismatch");
+        }
+    }
+    return view;
+}
+
+// Output path of every entry to extract. Entries that resolve to the same
+// path would overwrite each other, so only the last of them is written, the
+// one findEntry resolves the name to; the others are marked superseded.
+// Skipped entries, and entries whose path is rejected, get an empty path.
+std::vector<std::filesystem::path> planOutputPaths(const std::vector<RDXEntry>& entries,
+                                                   const std::filesystem::path& outputDir,
+                                                   std::vector<RDXExtractResult>& results) {
+    std::vector<std::filesystem::path> paths(entries.size());
+    std::unordered_map<std::string, std::size_t> lastByPath;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        try {
+            paths[i] = RDXReader::resolveOutputPath(outputDir, entries[i].fileName);
+        } catch (const std::exception& e) {
+            results[i].error = e.what();
+            continue;
+        }
+        
+        auto [last, inserted] = lastByPath.try_emplace(paths[i].string(), i);
+        if (!inserted) {
+            paths[last->second].clear();
+            results[last->second].success = true;
+            results[last->second].superseded = true;
+            last->second = i;
+        }
+    }
+    return paths;
+}
+
+} // namespace
+
 RDXReader::RDXReader(const std::filesystem::path& archivePath)
     : archivePath_(archivePath)
-    , indexOffset_(0) {
-    file_.open(archivePath, std::ios::binary | std::ios::in);
-    if (!file_.is_open()) {
+    , indexOffset_(0)
+    , indexEnd_(0)
+    , indexChecksum_(0)
+    , version_(0)
+    , flags_(0)
+    , baseIndexChecksum_(0)
+    , chainDepth_(0) {
+    try {
+        file_ = FileHandle(archivePath, FileHandle::Mode::Read);
+    } catch (const std::exception&) {
         throw std::runtime_error("Failed to open RDX file for reading: " + archivePath.string());
     }
     
@@ -16,38 +150,60 @@ RDXReader::RDXReader(const std::filesystem::path& archivePath)
     readIndex();
 }
 
-RDXReader::~RDXReader() {
-    if (file_.is_open()) {
-        file_.close();
-    }
-}
+RDXReader::~RDXReader() = default;
 
 void RDXReader::readHeader() {
-    // Read magic
-    std::uint32_t magic;
-    file_.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    // Magic, version, flags, index offset
+    std::uint8_t header[RDX_HEADER_SIZE];
+    file_.readAt(0, header, sizeof(header));
     
-    if (magic != RDXWriter::getMagic()) {
+    std::uint32_t magic;
+    std::memcpy(&magic, header, sizeof(magic));
+    if (magic != RDX_MAGIC) {
         throw std::runtime_error("Invalid RDX file magic number");
     }
     
-    // Read version
-    std::uint16_t version;
-    file_.read(reinterpret_cast<char*>(&version), sizeof(version));
+    std::memcpy(&version_, header + 4, sizeof(version_));
+    if (version_ == 0 || version_ > RDX_FORMAT_VERSION) {
+        throw std::runtime_error("Unsupported RDX format version: " + std::to_string(version_));
+    }
     
-    // Read flags
-    std::uint16_t flags;
-    file_.read(reinterpret_cast<char*>(&flags), sizeof(flags));
+    std::memcpy(&flags_, header + 6, sizeof(flags_));
+    std::memcpy(&indexOffset_, header + 8, sizeof(indexOffset_));
+    indexEnd_ = file_.size();
     
-    // Read index offset
-    file_.read(reinterpret_cast<char*>(&indexOffset_), sizeof(indexOffset_));
+    // Streaming archives carry the index offset in a footer after the index
+    if (flags_ & RDX_FLAG_STREAMING) {
+        if (indexEnd_ < static_cast<std::int64_t>(RDX_HEADER_SIZE + RDX_FOOTER_SIZE)) {
+            throw std::runtime_error("Truncated RDX archive: missing footer");
+        }
+        
+        std::uint8_t footer[RDX_FOOTER_SIZE];
+        indexEnd_ -= RDX_FOOTER_SIZE;
+        file_.readAt(indexEnd_, footer, sizeof(footer));
+        
+        std::uint32_t footerMagic;
+        std::memcpy(&footerMagic, footer + 8, sizeof(footerMagic));
+        if (footerMagic != RDX_FOOTER_MAGIC) {
+            throw std::runtime_error("Invalid RDX footer magic (truncated streaming archive?)");
+        }
+        std::memcpy(&indexOffset_, footer, sizeof(indexOffset_));
+    }
 }
 
 void RDXReader::readIndex() {
-    file_.seekg(indexOffset_);
+    if (indexOffset_ < static_cast<std::int64_t>(RDX_HEADER_SIZE) || indexOffset_ > indexEnd_) {
+        throw std::runtime_error("Corrupted RDX index: offset out of bounds");
+    }
+    
+    // Pull the whole index in with a single read and decode it from memory
+    ByteBuffer indexData;
+    indexData.resize(static_cast<std::size_t>(indexEnd_ - indexOffset_));
+    file_.readAt(indexOffset_, indexData.mutableDataPtr(), indexData.size());
+    indexChecksum_ = computeXXH64(indexData.data());
+    IndexCursor cursor(indexData);
     
-    std::uint32_t entryCount;
-    file_.read(reinterpret_cast<char*>(&entryCount), sizeof(entryCount));
+    std::uint32_t entryCount = cursor.read<std::uint32_t>();
     
     entries_.reserve(entryCount);
     
@@ -55,63 +211,721 @@ void RDXReader::readIndex() {
         RDXEntry entry;
         
         // Read file name
-        std::uint32_t nameLen;
-        file_.read(reinterpret_cast<char*>(&nameLen), sizeof(nameLen));
+        std::uint32_t nameLen = cursor.read<std::uint32_t>();
         entry.fileName.resize(nameLen);
-        file_.read(entry.fileName.data(), nameLen);
+        cursor.readBytes(entry.fileName.data(), nameLen);
         
         // Read entry metadata
-        file_.read(reinterpret_cast<char*>(&entry.originalSize), sizeof(entry.originalSize));
-        file_.read(reinterpret_cast<char*>(&entry.compressedStructSize), sizeof(entry.compressedStructSize));
-        file_.read(reinterpret_cast<char*>(&entry.compressedResidualSize), sizeof(entry.compressedResidualSize));
-        file_.read(reinterpret_cast<char*>(&entry.schemaId), sizeof(entry.schemaId));
-        file_.read(reinterpret_cast<char*>(&entry.fileTypeId), sizeof(entry.fileTypeId));
-        file_.read(reinterpret_cast<char*>(&entry.offset), sizeof(entry.offset));
-        file_.read(reinterpret_cast<char*>(&entry.blockSize), sizeof(entry.blockSize));
+        entry.originalSize = cursor.read<std::int64_t>();
+        entry.compressedStructSize = cursor.read<std::int64_t>();
+        entry.compressedResidualSize = cursor.read<std::int64_t>();
+        entry.schemaId = cursor.read<std::int32_t>();
+        entry.fileTypeId = cursor.read<std::int32_t>();
+        entry.offset = cursor.read<std::int64_t>();
+        entry.blockSize = cursor.read<std::int64_t>();
         
-        entries_.push_back(entry);
+        if (version_ >= 3) {
+            std::uint32_t extentCount = cursor.read<std::uint32_t>();
+            for (std::uint32_t j = 0; j < extentCount; ++j) {
+                ZeroExtent extent;
+                extent.offset = cursor.read<std::int64_t>();
+                extent.length = cursor.read<std::int64_t>();
+                entry.zeroExtents.push_back(extent);
+            }
+            try {
+                validateZeroExtents(entry.zeroExtents, entry.originalSize);
+            } catch (const std::exception&) {
+                throw std::runtime_error("Corrupted RDX index: invalid zero extent for entry: " + entry.fileName);
+            }
+        }
+        
+        if (version_ >= 4) {
+            std::uint8_t kind = cursor.read<std::uint8_t>();
+            if (kind > static_cast<std::uint8_t>(RDXEntryKind::BaseDelta)) {
+                throw std::runtime_error("Corrupted RDX index: unknown entry kind for entry: " + entry.fileName);
+            }
+            entry.kind = static_cast<RDXEntryKind>(kind);
+            if (entry.kind != RDXEntryKind::Block) {
+                std::uint32_t baseNameLen = cursor.read<std::uint32_t>();
+                entry.baseFileName.resize(baseNameLen);
+                cursor.readBytes(entry.baseFileName.data(), baseNameLen);
+                entry.baseEntryIndex = cursor.read<std::uint32_t>();
+                entry.baseContentChecksum = cursor.read<std::uint64_t>();
+            }
+        }
+        
+        entryByName_[entry.fileName] = entries_.size();
+        entries_.push_back(std::move(entry));
+    }
+    
+    // Delta base descriptor (format version 4)
+    if (version_ >= 4) {
+        std::uint32_t basePathLen = cursor.read<std::uint32_t>();
+        basePath_.resize(basePathLen);
+        cursor.readBytes(basePath_.data(), basePathLen);
+        baseIndexChecksum_ = cursor.read<std::uint64_t>();
+    }
+    
+    // Catalog (format version 5)
+    if (version_ >= 5) {
+        std::uint32_t fileTypeCount = cursor.read<std::uint32_t>();
+        for (std::uint32_t i = 0; i < fileTypeCount; ++i) {
+            std::int32_t fileTypeId = cursor.read<std::int32_t>();
+            catalog_.fileTypes[fileTypeId] = cursor.readString();
+        }
+        
+        std::uint32_t schemaCount = cursor.read<std::uint32_t>();
+        for (std::uint32_t i = 0; i < schemaCount; ++i) {
+            std::int32_t schemaId = cursor.read<std::int32_t>();
+            RDXSchemaRecord schema;
+            schema.name = cursor.readString();
+            schema.version = cursor.read<std::int32_t>();
+            schema.definition = cursor.readString();
+            catalog_.schemas[schemaId] = std::move(schema);
+        }
+    }
+}
+
+const RDXEntry* RDXReader::findEntry(const std::string& fileName) const {
+    auto it = entryByName_.find(fileName);
+    return it == entryByName_.end() ? nullptr : &entries_[it->second];
+}
+
+void RDXReader::setBaseArchivePath(const std::filesystem::path& basePath) {
+    std::lock_guard<std::mutex> lock(baseMutex_);
+    baseOverride_ = basePath;
+    base_.reset();
+}
+
+const RDXReader& RDXReader::base() const {
+    std::lock_guard<std::mutex> lock(baseMutex_);
+    if (base_) {
+        return *base_;
+    }
+    
+    if (basePath_.empty()) {
+        throw std::runtime_error("RDX archive has delta entries but no base archive: " + archivePath_.string());
+    }
+    if (chainDepth_ + 1 >= MAX_DELTA_CHAIN_DEPTH) {
+        throw std::runtime_error("RDX delta base chain too deep: " + archivePath_.string());
+    }
+    
+    std::filesystem::path path = baseOverride_;
+    if (path.empty()) {
+        path = std::filesystem::path(basePath_);
+        if (path.is_relative()) {
+            path = archivePath_.parent_path() / path;
+        }
+    }
+    
+    auto base = std::make_unique<RDXReader>(path);
+    if (base->getIndexChecksum() != baseIndexChecksum_) {
+        throw std::runtime_error("RDX base archive does not match the one this delta was written against: " +
+                                 path.string());
+    }
+    base->chainDepth_ = chainDepth_ + 1;
+    base_ = std::move(base);
+    return *base_;
+}
+
+const RDXEntry& RDXReader::baseEntryFor(const RDXEntry& entry) const {
+    const RDXReader& baseArchive = base();
+    
+    // The base entry is identified by position, since the base may hold
+    // several versions of a path, and its name must match as well
+    if (entry.baseEntryIndex >= baseArchive.entries_.size() ||
+        baseArchive.entries_[entry.baseEntryIndex].fileName != entry.baseFileName) {
+        throw std::runtime_error("RDX base archive has no entry '" + entry.baseFileName + "' at position " +
+                                 std::to_string(entry.baseEntryIndex) + " for: " + entry.fileName);
+    }
+    const RDXEntry& baseEntry = baseArchive.entries_[entry.baseEntryIndex];
+    std::optional<std::uint64_t> checksum = baseArchive.getContentChecksum(baseEntry);
+    if (checksum) {
+        checkBaseContent(entry, *checksum);
+    }
+    return baseEntry;
+}
+
+void RDXReader::checkBaseContent(const RDXEntry& entry, std::uint64_t checksum) const {
+    if (checksum != entry.baseContentChecksum) {
+        throw std::runtime_error("RDX base content checksum mismatch for entry: " + entry.fileName);
+    }
+}
+
+void RDXReader::readBaseContent(const RDXEntry& entry, DecompressionEngine& engine, ByteBuffer& out) const {
+    base().readEntryContent(baseEntryFor(entry), engine, out);
+    checkBaseContent(entry, computeXXH64(out.data()));
+}
+
+void RDXReader::readEntryContent(const RDXEntry& entry, DecompressionEngine& engine, ByteBuffer& out) const {
+    if (entry.kind == RDXEntryKind::BaseReference) {
+        readBaseContent(entry, engine, out);
+        return;
     }
+    
+    ByteBuffer baseContent;
+    if (entry.kind == RDXEntryKind::BaseDelta) {
+        readBaseContent(entry, engine, baseContent);
+    }
+    
+    ByteBuffer structStream;
+    ByteBuffer residualStream;
+    readBlock(entry, structStream, residualStream);
+    engine.decompressToBuffer(entry, structStream.data(), residualStream.data(), out, baseContent.data());
+}
+
+std::optional<std::uint64_t> RDXReader::getContentChecksum(const RDXEntry& entry) const {
+    if (entry.kind == RDXEntryKind::BaseReference) {
+        return entry.baseContentChecksum;
+    }
+    
+    RDXBlockHeader header = readBlockHeader(entry);
+    if (!header.hasChecksums) {
+        return std::nullopt;
+    }
+    return header.contentChecksum;
 }
 
 void RDXReader::listEntries(std::vector<RDXEntry>& outEntries) const {
     outEntries = entries_;
 }
 
-void RDXReader::readBlock(const RDXEntry& entry,
-                          ByteBuffer& outStructStream,
-                          ByteBuffer& outResidualStream) {
-    file_.seekg(entry.offset);
+RDXBlockHeader RDXReader::readBlockHeader(const RDXEntry& entry) const {
+    if (entry.kind == RDXEntryKind::BaseReference) {
+        throw std::runtime_error("RDX entry is stored in the base archive: " + entry.fileName);
+    }
     
-    // Read block magic
-    std::uint32_t blockMagic;
-    file_.read(reinterpret_cast<char*>(&blockMagic), sizeof(blockMagic));
+    // Block magic and header size
+    std::uint32_t prefix[2];
+    file_.readAt(entry.offset, prefix, sizeof(prefix));
     
-    // Read header size
-    std::uint32_t headerSize;
-    file_.read(reinterpret_cast<char*>(&headerSize), sizeof(headerSize));
+    if (prefix[0] != RDX_BLOCK_MAGIC_V1 && prefix[0] != RDX_BLOCK_MAGIC_V2) {
+        throw std::runtime_error("Invalid RDX block magic for entry: " + entry.fileName);
+    }
+    if (prefix[1] > MAX_BLOCK_HEADER_SIZE) {
+        throw std::runtime_error("Invalid RDX block header size for entry: " + entry.fileName);
+    }
     
-    // Skip header fields we don't need for reading
-    file_.seekg(entry.offset + sizeof(blockMagic) + sizeof(headerSize) + headerSize);
+    ByteBuffer headerBytes;
+    headerBytes.resize(prefix[1]);
+    file_.readAt(entry.offset, headerBytes.mutableDataPtr(), headerBytes.size());
+    return decodeBlockHeader(headerBytes.data());
+}
+
+void RDXReader::readBlock(const RDXEntry& entry,
+                          ByteBuffer& outStructStream,
+                          ByteBuffer& outResidualStream) const {
+    RDXBlockHeader header = readBlockHeader(entry);
+    
+    // Header size includes the magic and size fields; streams follow directly
+    std::int64_t dataOffset = entry.offset + header.headerSize;
     
-    // Read struct stream
     outStructStream.resize(static_cast<std::size_t>(entry.compressedStructSize));
-    file_.read(reinterpret_cast<char*>(outStructStream.mutableDataPtr()), entry.compressedStructSize);
+    if (entry.compressedStructSize > 0) {
+        file_.readAt(dataOffset, outStructStream.mutableDataPtr(), outStructStream.size());
+    }
     
-    // Read residual stream
     outResidualStream.resize(static_cast<std::size_t>(entry.compressedResidualSize));
-    file_.read(reinterpret_cast<char*>(outResidualStream.mutableDataPtr()), entry.compressedResidualSize);
+    if (entry.compressedResidualSize > 0) {
+        file_.readAt(dataOffset + entry.compressedStructSize,
+                     outResidualStream.mutableDataPtr(), outResidualStream.size());
+    }
+    
+    if (header.hasChecksums) {
+        XXH64State streamHash;
+        streamHash.update(outStructStream.data());
+        streamHash.update(outResidualStream.data());
+        if (streamHash.digest() != header.streamChecksum) {
+            throw std::runtime_error("Block checksum mismatch for entry: " + entry.fileName);
+        }
+    }
+}
+
+void RDXReader::readRawBlock(const RDXEntry& entry, ByteBuffer& outBlock) const {
+    if (entry.kind == RDXEntryKind::BaseReference) {
+        throw std::runtime_error("RDX entry is stored in the base archive: " + entry.fileName);
+    }
+    
+    if (entry.offset < static_cast<std::int64_t>(RDX_HEADER_SIZE) || entry.blockSize <= 0 ||
+        entry.offset + entry.blockSize > indexOffset_) {
+        throw std::runtime_error("Invalid RDX block bounds for entry: " + entry.fileName);
+    }
+    
+    outBlock.resize(static_cast<std::size_t>(entry.blockSize));
+    file_.readAt(entry.offset, outBlock.mutableDataPtr(), outBlock.size());
+    
+    try {
+        splitBlock(entry, outBlock.data());
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Corrupted RDX block for entry: " + entry.fileName + " (" + e.what() + ")");
+    }
 }
 
 void RDXReader::extractEntry(const RDXEntry& entry,
                              const std::filesystem::path& outputPath,
-                             DecompressionEngine& engine) {
-    ByteBuffer structStream;
-    ByteBuffer residualStream;
+                             DecompressionEngine& engine) const {
+    if (entry.kind == RDXEntryKind::BaseReference) {
+        base().extractEntry(baseEntryFor(entry), outputPath, engine);
+        std::int64_t size = 0;
+        checkBaseContent(entry, computeFileXXH64(outputPath, size));
+        return;
+    }
     
-    readBlock(entry, structStream, residualStream);
+    RDXBlockHeader header = readCheckedBlockHeader(entry);
     
-    engine.decompressToFile(entry, structStream, residualStream, outputPath);
+    ByteBuffer baseContent;
+    if (entry.kind == RDXEntryKind::BaseDelta) {
+        readBaseContent(entry, engine, baseContent);
+    }
+    
+    // The compressed streams are read in bounded chunks and hashed as the
+    // decoder consumes them, so memory does not grow with the entry
+    RDXEntryStream input(file_, entry, header);
+    input.skipCompressed(entry.compressedStructSize);
+    engine.decompressToFile(entry, [&input](std::span<std::byte> buffer) {
+        return input.readCompressed(buffer);
+    }, outputPath, baseContent.data());
+    input.checkStreamChecksum();
 }
 
-} // namespace rdx::core
+std::vector<RDXExtractResult> RDXReader::extractMany(const std::vector<RDXEntry>& entries,
+                                                     const std::filesystem::path& outputDir,
+                                                     DecompressionEngine& engine,
+                                                     unsigned threadCount) const {
+    std::vector<RDXExtractResult> results(entries.size());
+    std::vector<std::filesystem::path> outputPaths = planOutputPaths(entries, outputDir, results);
+    
+    // Failures are recorded per entry so one bad entry does not stop the rest
+    parallelFor(entries.size(), threadCount, [&](std::size_t i) {
+        const std::filesystem::path& outputPath = outputPaths[i];
+        if (outputPath.empty()) {
+            return;
+        }
+        try {
+            if (outputPath.has_parent_path()) {
+                std::filesystem::create_directories(outputPath.parent_path());
+            }
+            extractEntry(entries[i], outputPath, engine);
+            results[i].success = true;
+        } catch (const std::exception& e) {
+            results[i].error = e.what();
+        }
+    });
+    
+    return results;
+}
+
+std::vector<RDXExtractResult> RDXReader::extractSequential(const std::vector<RDXEntry>& entries,
+                                                           const std::filesystem::path& outputDir,
+                                                           DecompressionEngine& engine,
+                                                           const RDXPipelineOptions& options) const {
+    struct ReadJob {
+        std::size_t index;
+        std::size_t bytes;
+        ByteBuffer block;
+        std::string error;
+    };
+    
+    struct WriteJob {
+        std::size_t index;
+        std::size_t bytes;
+        ByteBuffer content;
+        bool packed = true;  // Zero extents left out (see decompressPacked)
+    };
+    
+    std::vector<RDXExtractResult> results(entries.size());
+    std::vector<std::filesystem::path> outputPaths = planOutputPaths(entries, outputDir, results);
+    
+    // Visit blocks in archive order so reads stay sequential on disk
+    std::vector<std::size_t> order;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        if (!outputPaths[i].empty()) {
+            order.push_back(i);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return entries[a].offset < entries[b].offset;
+    });
+    
+    // Private descriptor for the read-ahead stage's backend
+    FileHandle input(archivePath_, FileHandle::Mode::Read);
+    input.adviseSequential();
+    std::unique_ptr<IOBackend> io = createIOBackend(input, options.ioBackend, options.queueDepth);
+    
+    std::size_t stageBudget = std::max<std::size_t>(options.maxInFlightBytes / 2, 1);
+    std::size_t queueDepth = std::max(options.queueDepth, 1u);
+    ByteBudget readAhead(stageBudget);
+    ByteBudget writeBehind(stageBudget);
+    BlockingQueue<ReadJob> readQueue;
+    BlockingQueue<WriteJob> writeQueue;
+    
+    std::thread readerThread([&] {
+        std::vector<std::optional<ReadJob>> inFlight(entries.size());
+        std::vector<IORequest> batch;
+        std::vector<IOCompletion> completions;
+        std::size_t next = 0;
+        
+        while (next < order.size() || io->pending() > 0) {
+            // Queue further reads while the budget allows; block on the budget
+            // only when nothing is in flight that could make progress
+            batch.clear();
+            while (next < order.size() && io->pending() + batch.size() < queueDepth) {
+                const RDXEntry& entry = entries[order[next]];
+                std::size_t bytes = static_cast<std::size_t>(std::max<std::int64_t>(entry.blockSize, 0));
+                if (io->pending() == 0 && batch.empty()) {
+                    readAhead.acquire(bytes);
+                } else if (!readAhead.tryAcquire(bytes)) {
+                    break;
+                }
+                
+                ReadJob& job = inFlight[order[next]].emplace();
+                job.index = order[next];
+                job.bytes = bytes;
+                if (entry.kind == RDXEntryKind::BaseReference || entry.blockSize <= 0) {
+                    // References are resolved through the base by the decompressor
+                    if (entry.kind != RDXEntryKind::BaseReference) {
+                        job.error = "Invalid RDX block size for entry: " + entry.fileName;
+                    }
+                    readQueue.push(std::move(job));
+                    inFlight[order[next]].reset();
+                } else {
+                    job.block.resize(bytes);
+                    
+                    IORequest request;
+                    request.kind = IORequest::Kind::Read;
+                    request.offset = entry.offset;
+                    request.buffer = job.block.mutableDataPtr();
+                    request.length = bytes;
+                    request.userData = order[next];
+                    batch.push_back(request);
+                }
+                ++next;
+            }
+            
+            try {
+                io->submit(batch);
+                completions.clear();
+                io->waitCompletions(completions, 1);
+            } catch (const std::exception& e) {
+                // Ring failure: wait out reads still targeting our buffers,
+                // then fail everything not yet handed on
+                io.reset();
+                for (auto& job : inFlight) {
+                    if (job) {
+                        job->error = e.what();
+                        job->block = ByteBuffer();
+                        readQueue.push(std::move(*job));
+                        job.reset();
+                    }
+                }
+                for (; next < order.size(); ++next) {
+                    results[order[next]].error = e.what();
+                }
+                break;
+            }
+            
+            for (const IOCompletion& completion : completions) {
+                auto& job = inFlight[completion.userData];
+                if (completion.error != 0) {
+                    job->error = "Failed to read RDX block for entry: " + entries[job->index].fileName +
+                                 " (" + std::strerror(completion.error) + ")";
+                    job->block = ByteBuffer();
+                }
+                readQueue.push(std::move(*job));
+                job.reset();
+            }
+        }
+        readQueue.close();
+    });
+    
+    auto prepareOutputPath = [&](std::size_t index) {
+        const std::filesystem::path& outputPath = outputPaths[index];
+        if (outputPath.has_parent_path()) {
+            std::filesystem::create_directories(outputPath.parent_path());
+        }
+        return outputPath;
+    };
+    
+    std::thread writerThread([&] {
+        while (auto job = writeQueue.pop()) {
+            try {
+                const RDXEntry& entry = entries[job->index];
+                std::filesystem::path outputPath = prepareOutputPath(job->index);
+                FileHandle output(outputPath, FileHandle::Mode::Write);
+                writeWithHoles(output, job->content.data(),
+                               job->packed ? entry.zeroExtents : std::vector<ZeroExtent>{}, entry.originalSize);
+                results[job->index].success = true;
+            } catch (const std::exception& e) {
+                results[job->index].error = e.what();
+            }
+            job->content = ByteBuffer();
+            writeBehind.release(job->bytes);
+        }
+    });
+    
+    // Decompress on the calling thread while the other two stages run
+    while (auto job = readQueue.pop()) {
+        const RDXEntry& entry = entries[job->index];
+        
+        if (job->error.empty()) {
+            try {
+                WriteJob writeJob;
+                writeJob.index = job->index;
+                
+                if (entry.kind == RDXEntryKind::BaseReference) {
+                    writeJob.bytes = static_cast<std::size_t>(entry.originalSize);
+                    writeJob.packed = false;
+                } else {
+                    // Zero extents are never materialized; the writer leaves holes
+                    writeJob.bytes = static_cast<std::size_t>(entry.originalSize - totalZeroBytes(entry.zeroExtents));
+                }
+                
+                BlockView view;
+                ByteBuffer baseContent;
+                if (entry.kind != RDXEntryKind::BaseReference) {
+                    try {
+                        view = splitBlock(entry, job->block.data());
+                    } catch (const std::exception& e) {
+                        throw std::runtime_error("Corrupted RDX block for entry: " + entry.fileName + " (" +
+                                                 e.what() + ")");
+                    }
+                    if (entry.kind == RDXEntryKind::BaseDelta) {
+                        readBaseContent(entry, engine, baseContent);
+                    }
+                }
+                
+                if (writeJob.bytes > stageBudget) {
+                    // Too large to hand to the writer: stream it to its file
+                    // from here through a fixed window instead
+                    std::filesystem::path outputPath = prepareOutputPath(job->index);
+                    if (entry.kind == RDXEntryKind::BaseReference) {
+                        extractEntry(entry, outputPath, engine);
+                    } else {
+                        engine.decompressToFile(entry, view.structStream, view.residualStream, outputPath,
+                                                baseContent.data());
+                    }
+                    results[job->index].success = true;
+                } else {
+                    writeBehind.acquire(writeJob.bytes);
+                    try {
+                        if (entry.kind == RDXEntryKind::BaseReference) {
+                            readEntryContent(entry, engine, writeJob.content);
+                        } else {
+                            engine.decompressPacked(entry, view.structStream, view.residualStream, writeJob.content,
+                                                    baseContent.data());
+                        }
+                    } catch (...) {
+                        writeBehind.release(writeJob.bytes);
+                        throw;
+                    }
+                    writeQueue.push(std::move(writeJob));
+                }
+            } catch (const std::exception& e) {
+                results[job->index].error = e.what();
+            }
+        } else {
+            results[job->index].error = job->error;
+        }
+        
+        job->block = ByteBuffer();
+        readAhead.release(job->bytes);
+    }
+    
+    writeQueue.close();
+    readerThread.join();
+    writerThread.join();
+    
+    return results;
+}
+
+RDXEntryStream::RDXEntryStream(const FileHandle& file, const RDXEntry& entry, const RDXBlockHeader& header)
+    : file_(file)
+    , fileName_(entry.fileName)
+    , header_(header)
+    , inputOffset_(entry.offset + header.headerSize)
+    , inputRemaining_(entry.compressedStructSize + entry.compressedResidualSize)
+    , verified_(false) {
+}
+
+RDXEntryStream::~RDXEntryStream() = default;
+
+std::int64_t RDXEntryStream::size() const {
+    return decoder_->size();
+}
 
+std::int64_t RDXEntryStream::position() const {
+    return decoder_->position();
+}
+
+std::size_t RDXEntryStream::readCompressed(std::span<std::byte> buffer) {
+    std::size_t count = static_cast<std::size_t>(std::min<std::int64_t>(inputRemaining_, buffer.size()));
+    if (count > 0) {
+        file_.readAt(inputOffset_, buffer.data(), count);
+        streamHash_.update(buffer.first(count));
+        inputOffset_ += static_cast<std::int64_t>(count);
+        inputRemaining_ -= static_cast<std::int64_t>(count);
+    }
+    return count;
+}
+
+void RDXEntryStream::skipCompressed(std::int64_t length) {
+    ByteBuffer chunk;
+    chunk.resize(static_cast<std::size_t>(std::min<std::int64_t>(length, ENTRY_STREAM_READ_SIZE)));
+    for (std::int64_t skipped = 0; skipped < length;) {
+        std::size_t count = static_cast<std::size_t>(std::min<std::int64_t>(length - skipped, chunk.size()));
+        readCompressed(std::span<std::byte>(chunk.mutableDataPtr(), count));
+        skipped += static_cast<std::int64_t>(count);
+    }
+}
+
+void RDXEntryStream::checkStreamChecksum() const {
+    if (header_.hasChecksums && (inputRemaining_ != 0 || streamHash_.digest() != header_.streamChecksum)) {
+        throw std::runtime_error("Block checksum mismatch for entry: " + fileName_);
+    }
+}
+
+std::size_t RDXEntryStream::read(std::span<std::byte> out) {
+    std::size_t count = decoder_->read(out);
+    contentHash_.update(out.first(count));
+    
+    if (decoder_->position() == decoder_->size() && !verified_) {
+        verified_ = true;
+        checkStreamChecksum();
+        if (header_.hasChecksums) {
+            if (contentHash_.digest() != header_.contentChecksum) {
+                throw std::runtime_error("Content checksum mismatch for entry: " + fileName_);
+            }
+        }
+    }
+    return count;
+}
+
+RDXBlockHeader RDXReader::readCheckedBlockHeader(const RDXEntry& entry) const {
+    if (entry.offset < static_cast<std::int64_t>(RDX_HEADER_SIZE) || entry.blockSize <= 0 ||
+        entry.offset + entry.blockSize > indexOffset_) {
+        throw std::runtime_error("Invalid RDX block bounds for entry: " + entry.fileName);
+    }
+    
+    RDXBlockHeader header = readBlockHeader(entry);
+    try {
+        validateBlockHeader(entry, header);
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Corrupted RDX block for entry: " + entry.fileName + " (" + e.what() + ")");
+    }
+    return header;
+}
+
+std::unique_ptr<RDXEntryStream> RDXReader::openEntryStream(const RDXEntry& entry, DecompressionEngine& engine) const {
+    if (entry.kind == RDXEntryKind::BaseReference) {
+        return base().openEntryStream(baseEntryFor(entry), engine);
+    }
+    
+    RDXBlockHeader header = readCheckedBlockHeader(entry);
+    
+    ByteBuffer baseContent;
+    if (entry.kind == RDXEntryKind::BaseDelta) {
+        readBaseContent(entry, engine, baseContent);
+    }
+    
+    std::unique_ptr<RDXEntryStream> stream(new RDXEntryStream(file_, entry, header));
+    
+    // The structural stream is not needed to rebuild content in this format
+    // version, but it is covered by the stream checksum
+    stream->skipCompressed(entry.compressedStructSize);
+    
+    RDXEntryStream* target = stream.get();
+    stream->decoder_ = engine.openDecoder(entry, [target](std::span<std::byte> buffer) {
+        return target->readCompressed(buffer);
+    }, std::move(baseContent));
+    return stream;
+}
+
+std::vector<RDXExtractResult> RDXReader::extractAll(const std::filesystem::path& outputDir,
+                                                    DecompressionEngine& engine,
+                                                    unsigned threadCount) const {
+    return extractMany(entries_, outputDir, engine, threadCount);
+}
+
+RDXVerifyReport RDXReader::verifyArchive(unsigned threadCount) const {
+    return verify(nullptr, threadCount);
+}
+
+RDXVerifyReport RDXReader::verifyArchive(DecompressionEngine& engine, unsigned threadCount) const {
+    return verify(&engine, threadCount);
+}
+
+RDXVerifyReport RDXReader::verify(DecompressionEngine* engine, unsigned threadCount) const {
+    MappedFile mapping(archivePath_);
+    std::span<const std::byte> archive = mapping.data();
+    
+    std::vector<std::optional<std::string>> problems(entries_.size());
+    std::atomic<std::size_t> withoutChecksums{0};
+    
+    parallelFor(entries_.size(), threadCount, [&](std::size_t i) {
+        const RDXEntry& entry = entries_[i];
+        try {
+            if (entry.kind == RDXEntryKind::BaseReference) {
+                // Nothing is stored here; the base must still provide the content
+                baseEntryFor(entry);
+                if (engine) {
+                    ByteBuffer content;
+                    readEntryContent(entry, *engine, content);
+                    if (computeXXH64(content.data()) != entry.baseContentChecksum) {
+                        throw std::runtime_error("content checksum mismatch");
+                    }
+                }
+                return;
+            }
+            
+            if (entry.offset < static_cast<std::int64_t>(RDX_HEADER_SIZE) || entry.blockSize <= 0 ||
+                entry.offset + entry.blockSize > static_cast<std::int64_t>(archive.size())) {
+                throw std::runtime_error("block is outside the archive");
+            }
+            
+            std::span<const std::byte> block = archive.subspan(static_cast<std::size_t>(entry.offset),
+                                                               static_cast<std::size_t>(entry.blockSize));
+            BlockView view = splitBlock(entry, block);
+            if (!view.header.hasChecksums) {
+                withoutChecksums.fetch_add(1, std::memory_order_relaxed);
+            }
+            
+            const RDXEntry* baseEntry = entry.kind == RDXEntryKind::BaseDelta ? &baseEntryFor(entry) : nullptr;
+            
+            if (engine) {
+                ByteBuffer baseContent;
+                if (baseEntry) {
+                    readBaseContent(entry, *engine, baseContent);
+                }
+                std::uint64_t contentChecksum = engine->computeContentChecksum(entry, view.structStream,
+                                                                               view.residualStream,
+                                                                               baseContent.data());
+                if (view.header.hasChecksums && contentChecksum != view.header.contentChecksum) {
+                    throw std::runtime_error("content checksum mismatch");
+                }
+            }
+        } catch (const std::exception& e) {
+            problems[i] = e.what();
+        }
+    });
+    
+    RDXVerifyReport report;
+    report.entriesChecked = entries_.size();
+    report.entriesWithoutChecksums = withoutChecksums.load();
+    for (std::size_t i = 0; i < problems.size(); ++i) {
+        if (problems[i]) {
+            report.issues.push_back({entries_[i].fileName, *problems[i]});
+        }
+    }
+    return report;
+}
+
+std::filesystem::path RDXReader::resolveOutputPath(const std::filesystem::path& outputDir,
+                                                   const std::string& archivePath) {
+    std::filesystem::path relative = std::filesystem::path(archivePath).lexically_normal();
+    if (relative.empty() || relative.has_root_path() || *relative.begin() == "..") {
+        throw std::runtime_error("Refusing to extract entry outside output directory: " + archivePath);
+    }
+    return outputDir / relative;
+}
+
+} // namespace rdx::core
@@ -2,9 +2,18 @@
 #define RDX_RDXREADER_H
 
 #include "container/RDXWriter.h"
+#include "util/FileHandle.h"
+#include "util/HashUtils.h"
+#include "util/IOBackend.h"
+#include <cstdint>
 #include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
 #include <vector>
-#include <fstream>
 
 namespace rdx::core {
     class DecompressionEngine;
@@ -12,6 +21,88 @@ namespace rdx::core {
 
 namespace rdx::core {
 
+struct RDXExtractResult {
+    bool success = false;
+    
+    // Not written: a later entry extracts to the same path (e.g. a file
+    // re-added in append mode), and the last entry wins as in findEntry
+    bool superseded = false;
+    std::string error;
+};
+
+struct RDXPipelineOptions {
+    // Upper bound on bytes buffered between stages, split evenly between
+    // read-ahead (compressed blocks) and write-behind (decompressed content).
+    // Entries larger than the write-behind share bypass it and are streamed
+    // to their file by the decompression stage.
+    std::size_t maxInFlightBytes = 256 * 1024 * 1024;
+    
+    // Read-ahead submits whole-block reads in batches of up to `queueDepth`
+    // and hands blocks on as they complete
+    IOBackendKind ioBackend = IOBackendKind::Auto;
+    unsigned queueDepth = 32;
+};
+
+struct RDXVerifyIssue {
+    std::string fileName;
+    std::string message;
+};
+
+struct RDXVerifyReport {
+    std::size_t entriesChecked = 0;
+    std::size_t entriesWithoutChecksums = 0;  // Version 1 blocks: structure checked only
+    std::vector<RDXVerifyIssue> issues;
+    
+    bool ok() const { return issues.empty(); }
+};
+
+class EntryDecoder;
+
+// Pull-based reader over one entry's content (see RDXReader::openEntryStream).
+// The archive is read in small chunks as the caller pulls, so memory stays
+// bounded whatever the entry size. The block's checksums are checked as the
+// end is reached: the read that returns the last bytes throws on corruption.
+class RDXEntryStream {
+public:
+    ~RDXEntryStream();
+    
+    RDXEntryStream(const RDXEntryStream&) = delete;
+    RDXEntryStream& operator=(const RDXEntryStream&) = delete;
+    
+    // Fills `out` with the next bytes and returns the count; 0 at the end
+    std::size_t read(std::span<std::byte> out);
+    
+    std::int64_t size() const;
+    std::int64_t position() const;
+
+private:
+    friend class RDXReader;
+    
+    RDXEntryStream(const FileHandle& file, const RDXEntry& entry, const RDXBlockHeader& header);
+    
+    const FileHandle& file_;
+    std::string fileName_;
+    RDXBlockHeader header_;
+    std::int64_t inputOffset_;
+    std::int64_t inputRemaining_;
+    XXH64State streamHash_;
+    XXH64State contentHash_;
+    std::unique_ptr<EntryDecoder> decoder_;
+    bool verified_;
+    
+    std::size_t readCompressed(std::span<std::byte> buffer);
+    void skipCompressed(std::int64_t length);
+    
+    // Throws unless the compressed bytes read so far match the block's stream checksum
+    void checkStreamChecksum() const;
+};
+
+// All read operations use positional I/O and leave the reader unchanged,
+// so a single RDXReader may be shared by several extraction threads.
+//
+// Delta archives (see RDXWriter::setDeltaBase) are read transparently: the
+// base archive is opened on first use and entries stored as references or
+// deltas are resolved through it, and through its own base, if any.
 class RDXReader {
 public:
     explicit RDXReader(const std::filesystem::path& archivePath);
@@ -19,25 +110,122 @@ public:
     
     void listEntries(std::vector<RDXEntry>& outEntries) const;
     
+    // Last entry stored under `fileName`, or nullptr
+    const RDXEntry* findEntry(const std::string& fileName) const;
+    
+    std::int64_t getIndexOffset() const { return indexOffset_; }
+    
+    // XXH64 of the serialized index; delta archives record their base's
+    // to detect a replaced or modified base
+    std::uint64_t getIndexChecksum() const { return indexChecksum_; }
+    
+    bool isDelta() const { return !basePath_.empty(); }
+    
+    // Base archive path as recorded by the writer (empty if not a delta)
+    const std::string& getBasePath() const { return basePath_; }
+    std::uint64_t getBaseIndexChecksum() const { return baseIndexChecksum_; }
+    
+    // Schema and file type tables embedded by the writer (empty before
+    // format version 5); lets tools describe entries without the LCM
+    const RDXCatalog& getCatalog() const { return catalog_; }
+    
+    // Overrides where the base archive is looked for. By default the recorded
+    // path is resolved relative to this archive's directory.
+    void setBaseArchivePath(const std::filesystem::path& basePath);
+    
+    // Reconstructs an entry's full content in memory, following the base
+    // chain for delta entries
+    void readEntryContent(const RDXEntry& entry, DecompressionEngine& engine, ByteBuffer& out) const;
+    
+    // Content checksum of an entry (from its block header, or as recorded
+    // for references); empty for version 1 blocks
+    std::optional<std::uint64_t> getContentChecksum(const RDXEntry& entry) const;
+    
     void extractEntry(const RDXEntry& entry,
                       const std::filesystem::path& outputPath,
-                      DecompressionEngine& engine);
+                      DecompressionEngine& engine) const;
     
+    // Extracts entries below outputDir (keeping their archive paths) on a
+    // pool of `threadCount` workers (0 = one per hardware thread). Of several
+    // entries with the same output path only the last in `entries` is
+    // written; the others succeed as superseded.
+    // Returns one result per entry, in the same order as `entries`.
+    std::vector<RDXExtractResult> extractMany(const std::vector<RDXEntry>& entries,
+                                              const std::filesystem::path& outputDir,
+                                              DecompressionEngine& engine,
+                                              unsigned threadCount = 0) const;
+    
+    // Pipelined extraction for slow or seek-bound storage: a read-ahead thread
+    // keeps a queue of block reads in flight (io_uring where available), the
+    // calling thread decompresses blocks as they arrive, and a write-behind
+    // thread writes finished files, so disk and CPU overlap. Entries sharing
+    // an output path are handled as in extractMany.
+    std::vector<RDXExtractResult> extractSequential(const std::vector<RDXEntry>& entries,
+                                                    const std::filesystem::path& outputDir,
+                                                    DecompressionEngine& engine,
+                                                    const RDXPipelineOptions& options = {}) const;
+    
+    // Opens the entry for reading without extracting it, e.g. to serve it
+    // over the network. The stream must not outlive this reader.
+    std::unique_ptr<RDXEntryStream> openEntryStream(const RDXEntry& entry, DecompressionEngine& engine) const;
+    
+    std::vector<RDXExtractResult> extractAll(const std::filesystem::path& outputDir,
+                                             DecompressionEngine& engine,
+                                             unsigned threadCount = 0) const;
+    
+    // Reads both streams of an entry; throws if the block checksum does not match
     void readBlock(const RDXEntry& entry,
                    ByteBuffer& outStructStream,
-                   ByteBuffer& outResidualStream);
+                   ByteBuffer& outResidualStream) const;
+    
+    RDXBlockHeader readBlockHeader(const RDXEntry& entry) const;
+    
+    // Reads an entry's block exactly as stored (header and both streams) for
+    // copying into another archive; throws if it fails validation
+    void readRawBlock(const RDXEntry& entry, ByteBuffer& outBlock) const;
+    
+    // Fast verification: checks every block's structure and stream checksum
+    // in parallel straight from a memory mapping, without decompressing
+    RDXVerifyReport verifyArchive(unsigned threadCount = 0) const;
+    
+    // Full verification: additionally decompresses every entry in memory and
+    // checks the content checksum; nothing is written to disk
+    RDXVerifyReport verifyArchive(DecompressionEngine& engine, unsigned threadCount = 0) const;
+    
+    // Maps an archive path onto outputDir, rejecting absolute paths and ".."
+    static std::filesystem::path resolveOutputPath(const std::filesystem::path& outputDir,
+                                                   const std::string& archivePath);
 
 private:
     std::filesystem::path archivePath_;
-    std::ifstream file_;
+    FileHandle file_;
     std::vector<RDXEntry> entries_;
+    std::unordered_map<std::string, std::size_t> entryByName_;
     std::int64_t indexOffset_;
+    std::int64_t indexEnd_;
+    std::uint64_t indexChecksum_;
+    std::uint16_t version_;
+    std::uint16_t flags_;
+    RDXCatalog catalog_;
+    
+    // Delta archives
+    std::string basePath_;
+    std::uint64_t baseIndexChecksum_;
+    std::filesystem::path baseOverride_;
+    unsigned chainDepth_;
+    mutable std::mutex baseMutex_;
+    mutable std::unique_ptr<RDXReader> base_;
     
     void readHeader();
     void readIndex();
+    RDXBlockHeader readCheckedBlockHeader(const RDXEntry& entry) const;
+    const RDXReader& base() const;
+    const RDXEntry& baseEntryFor(const RDXEntry& entry) const;
+    void readBaseContent(const RDXEntry& entry, DecompressionEngine& engine, ByteBuffer& out) const;
+    void checkBaseContent(const RDXEntry& entry, std::uint64_t checksum) const;
+    RDXVerifyReport verify(DecompressionEngine* engine, unsigned threadCount) const;
 };
 
 } // namespace rdx::core
 
 #endif // RDX_RDXREADER_H
-
@@ -1,152 +1,552 @@
 #include "container/RDXWriter.h"
+#include "container/RDXReader.h"
 #include "compression/CompressionEngine.h"
+#include "lcm/LCMWriteQueue.h"
+#include "util/FileHandle.h"
+#include "util/BlockingQueue.h"
+#include "util/HashUtils.h"
+#include <algorithm>
 #include <cstring>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
 
 namespace rdx::core {
 
-RDXWriter::RDXWriter(const std::filesystem::path& outputPath)
-    : outputPath_(outputPath)
-    , currentOffset_(0) {
-    file_.open(outputPath, std::ios::binary | std::ios::out);
-    if (!file_.is_open()) {
-        throw std::runtime_error("Failed to open RDX file for writing: " + outputPath.string());
+namespace {
+
+// Paths the directory walker may find ahead of compression. Walking is much
+// faster than compressing, so without a bound a large tree would end up
+// queued in memory.
+constexpr std::size_t DIRECTORY_QUEUE_CAPACITY = 4096;
+
+// Chunk size for comparing a file with a base entry's content
+constexpr std::size_t COMPARE_CHUNK_SIZE = 1024 * 1024;
+
+} // namespace
+
+void RDXCatalog::merge(const RDXCatalog& other) {
+    // Check everything before adding anything, so a conflict leaves this unchanged
+    for (const auto& [id, name] : other.fileTypes) {
+        auto existing = fileTypes.find(id);
+        if (existing != fileTypes.end() && existing->second != name) {
+            throw std::runtime_error("Conflicting catalog records for file type ID " + std::to_string(id) + ": '" +
+                                     existing->second + "' and '" + name + "'");
+        }
+    }
+    for (const auto& [id, schema] : other.schemas) {
+        auto existing = schemas.find(id);
+        if (existing != schemas.end() &&
+            (existing->second.name != schema.name || existing->second.version != schema.version)) {
+            throw std::runtime_error("Conflicting catalog records for schema ID " + std::to_string(id) + ": '" +
+                                     existing->second.name + "' and '" + schema.name + "'");
+        }
+    }
+    
+    fileTypes.insert(other.fileTypes.begin(), other.fileTypes.end());
+    schemas.insert(other.schemas.begin(), other.schemas.end());
+}
+
+RDXWriter::RDXWriter(const std::filesystem::path& outputPath, RDXOpenMode mode)
+    : currentOffset_(0)
+    , streaming_(false) {
+    if (mode == RDXOpenMode::Append && std::filesystem::exists(outputPath)) {
+        openForAppend(outputPath);
+        return;
     }
     
+    try {
+        sink_ = std::make_unique<FileSink>(outputPath);
+    } catch (const std::exception&) {
+        throw std::runtime_error("Failed to open RDX file for writing: " + outputPath.string());
+    }
+    writeHeader();
+}
+
+RDXWriter::RDXWriter(std::unique_ptr<ArchiveSink> sink)
+    : sink_(std::move(sink))
+    , currentOffset_(0)
+    , streaming_(false) {
+    if (!sink_) {
+        throw std::invalid_argument("RDXWriter requires an output sink");
+    }
+    streaming_ = !sink_->canSeek();
     writeHeader();
 }
 
 RDXWriter::~RDXWriter() {
-    if (file_.is_open()) {
-        finalize();
+    // Destructors must not throw; callers that need to see a failure call
+    // finalize() themselves
+    if (sink_) {
+        try {
+            finalize();
+        } catch (const std::exception& e) {
+            std::cerr << "RDXWriter: failed to finalize archive: " << e.what() << std::endl;
+        }
+    }
+}
+
+void RDXWriter::openForAppend(const std::filesystem::path& outputPath) {
+    // Load the existing index; its entries are carried over unchanged
+    std::int64_t indexOffset = 0;
+    {
+        RDXReader reader(outputPath);
+        reader.listEntries(entries_);
+        indexOffset = reader.getIndexOffset();
+        for (const RDXEntry& entry : entries_) {
+            if (entry.kind != RDXEntryKind::BaseReference) {
+                blockSizes_.emplace(entry.offset, entry.blockSize);
+            }
+        }
+        
+        // Keep the delta base; new files only become references again if
+        // setDeltaBase is called with the same base
+        storedBasePath_ = reader.getBasePath();
+        baseIndexChecksum_ = reader.getBaseIndexChecksum();
+        catalog_ = reader.getCatalog();
+    }
+    
+    // New blocks overwrite the old index (and footer), which are rewritten in
+    // finalize. Existing blocks are never read or rewritten.
+    try {
+        sink_ = std::make_unique<FileSink>(outputPath, indexOffset);
+    } catch (const std::exception&) {
+        throw std::runtime_error("Failed to open RDX file for appending: " + outputPath.string());
     }
+    currentOffset_ = indexOffset;
+}
+
+void RDXWriter::writeBytes(std::span<const std::byte> data) {
+    sink_->write(data);
+    currentOffset_ += static_cast<std::int64_t>(data.size());
 }
 
 void RDXWriter::writeHeader() {
-    // Write magic number
-    std::uint32_t magic = RDX_MAGIC;
-    file_.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+    // Seekable outputs get the index offset patched in finalize; streaming
+    // archives leave it at 0 and carry it in the footer
+    ByteBuffer header = encodeArchiveHeader(streaming_ ? RDX_FLAG_STREAMING : 0, 0);
+    writeBytes(header.data());
+}
+
+void RDXWriter::setDeltaBase(const std::filesystem::path& basePath,
+                             DecompressionEngine& engine,
+                             const RDXDeltaOptions& options) {
+    auto base = std::make_unique<RDXReader>(basePath);
     
-    // Write version
-    std::uint16_t version = RDX_VERSION;
-    file_.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    if (!storedBasePath_.empty() && base->getIndexChecksum() != baseIndexChecksum_) {
+        throw std::runtime_error("Archive is already a delta against a different base: " + storedBasePath_);
+    }
     
-    // Write flags (reserved for future use)
-    std::uint16_t flags = 0;
-    file_.write(reinterpret_cast<const char*>(&flags), sizeof(flags));
+    // Index the base by content; entries without a content checksum
+    // (version 1 blocks) can still serve as patch bases, just not as references
+    baseEntries_.clear();
+    baseByName_.clear();
+    baseByContent_.clear();
+    base->listEntries(baseEntries_);
+    for (std::uint32_t i = 0; i < baseEntries_.size(); ++i) {
+        const RDXEntry& entry = baseEntries_[i];
+        baseByName_[entry.fileName] = i;
+        if (auto checksum = base->getContentChecksum(entry)) {
+            baseByContent_[{entry.originalSize, *checksum}].push_back(i);
+        }
+    }
     
-    // Reserve space for index offset (will be written in finalize)
-    std::int64_t indexOffsetPlaceholder = 0;
-    file_.write(reinterpret_cast<const char*>(&indexOffsetPlaceholder), sizeof(indexOffsetPlaceholder));
+    // References copy their schema and file type ids from the base
+    catalog_.merge(base->getCatalog());
     
-    currentOffset_ = sizeof(magic) + sizeof(version) + sizeof(flags) + sizeof(indexOffsetPlaceholder);
+    deltaOptions_ = options;
+    storedBasePath_ = options.storedBasePath.empty() ? basePath.filename().string() : options.storedBasePath;
+    baseIndexChecksum_ = base->getIndexChecksum();
+    baseEngine_ = &engine;
+    base_ = std::move(base);
 }
 
 void RDXWriter::addFile(const std::filesystem::path& inputPath,
                         CompressionEngine& engine,
                         const std::string& archivePath) {
+    std::string fileName = archivePath.empty() ? inputPath.filename().string() : archivePath;
+    
+    if (const auto& queue = engine.getWriteQueue()) {
+        if (std::find(lcmQueues_.begin(), lcmQueues_.end(), queue) == lcmQueues_.end()) {
+            lcmQueues_.push_back(queue);
+        }
+    }
+    
     ByteBuffer structStream;
     ByteBuffer residualStream;
+    ByteBuffer patchBase;
+    RDXEntryKind kind = RDXEntryKind::Block;
+    std::string baseFileName;
+    std::uint32_t baseEntryIndex = 0;
+    std::uint64_t baseContentChecksum = 0;
+    
+    if (base_) {
+        // Unchanged content anywhere in the base: store a reference only.
+        // A hash match only nominates candidates; the content is compared
+        // byte for byte before it is trusted.
+        std::int64_t size = 0;
+        std::uint64_t checksum = computeFileXXH64(inputPath, size);
+        auto candidates = baseByContent_.find({size, checksum});
+        if (candidates != baseByContent_.end()) {
+            for (std::uint32_t index : candidates->second) {
+                if (!matchesBaseEntry(inputPath, baseEntries_[index])) {
+                    continue;
+                }
+                RDXEntry entry = baseEntries_[index];
+                entry.fileName = fileName;
+                entry.kind = RDXEntryKind::BaseReference;
+                entry.baseFileName = baseEntries_[index].fileName;
+                entry.baseEntryIndex = index;
+                entry.baseContentChecksum = checksum;
+                entry.compressedStructSize = 0;
+                entry.compressedResidualSize = 0;
+                entry.offset = 0;
+                entry.blockSize = 0;
+                entries_.push_back(std::move(entry));
+                return;
+            }
+        }
+        
+        // Changed file: compress against the previous version under the same path
+        auto previous = baseByName_.find(fileName);
+        if (previous != baseByName_.end()) {
+            const RDXEntry& previousEntry = baseEntries_[previous->second];
+            if (previousEntry.originalSize > 0 && previousEntry.originalSize <= deltaOptions_.maxPatchBaseSize) {
+                base_->readEntryContent(previousEntry, *baseEngine_, patchBase);
+                kind = RDXEntryKind::BaseDelta;
+                baseFileName = fileName;
+                baseEntryIndex = previous->second;
+                baseContentChecksum = computeXXH64(patchBase.data());
+            }
+        }
+    }
+    
+    auto result = engine.compressFile(inputPath, structStream, residualStream, patchBase.data());
     
-    auto result = engine.compressFile(inputPath, structStream, residualStream);
+    // Before the block is written: the archive may already use these IDs for
+    // other records (entries compressed with another LCM)
+    RDXCatalog records;
+    records.fileTypes.emplace(result.fileTypeId, result.fileTypeName);
+    records.schemas.emplace(result.schemaId,
+                            RDXSchemaRecord{result.schemaName, result.schemaVersion, result.schemaDefinition});
+    catalog_.merge(records);
     
-    std::int64_t blockOffset = writeBlock(structStream, residualStream, result.schemaId, result.fileTypeId, result.originalSize);
+    RDXBlockHeader header;
+    header.schemaId = result.schemaId;
+    header.fileTypeId = result.fileTypeId;
+    header.originalSize = result.originalSize;
+    header.contentChecksum = result.contentChecksum;
+    if (!result.zeroExtents.empty()) {
+        header.flags |= RDX_BLOCK_FLAG_ZERO_EXTENTS;
+    }
+    std::int64_t blockOffset = writeBlock(header, structStream, residualStream);
     
     RDXEntry entry;
-    entry.fileName = archivePath.empty() ? inputPath.filename().string() : archivePath;
+    entry.fileName = fileName;
     entry.originalSize = result.originalSize;
     entry.compressedStructSize = static_cast<std::int64_t>(structStream.size());
     entry.compressedResidualSize = static_cast<std::int64_t>(residualStream.size());
     entry.schemaId = result.schemaId;
     entry.fileTypeId = result.fileTypeId;
     entry.offset = blockOffset;
-    entry.blockSize = sizeof(std::uint32_t) + sizeof(std::uint32_t) + 
-                      sizeof(std::int32_t) + sizeof(std::int32_t) +
-                      sizeof(std::int64_t) + sizeof(std::int64_t) + sizeof(std::int64_t) +
-                      sizeof(std::uint16_t) +
-                      static_cast<std::int64_t>(structStream.size() + residualStream.size());
+    entry.blockSize = currentOffset_ - blockOffset;
+    entry.zeroExtents = std::move(result.zeroExtents);
+    entry.kind = kind;
+    entry.baseFileName = baseFileName;
+    entry.baseEntryIndex = baseEntryIndex;
+    entry.baseContentChecksum = baseContentChecksum;
+    blockSizes_.emplace(entry.offset, entry.blockSize);
     
-    entries_.push_back(entry);
+    entries_.push_back(std::move(entry));
 }
 
-std::int64_t RDXWriter::writeBlock(const ByteBuffer& structStream, const ByteBuffer& residualStream,
-                                   int schemaId, int fileTypeId, std::int64_t originalSize) {
-    std::int64_t blockOffset = currentOffset_;
+bool RDXWriter::matchesBaseEntry(const std::filesystem::path& inputPath, const RDXEntry& baseEntry) {
+    FileHandle input(inputPath, FileHandle::Mode::Read);
+    std::int64_t size = input.size();
+    if (size != baseEntry.originalSize) {
+        return false;
+    }
+    
+    auto stream = base_->openEntryStream(baseEntry, *baseEngine_);
+    std::vector<std::byte> expected(COMPARE_CHUNK_SIZE);
+    std::vector<std::byte> actual(COMPARE_CHUNK_SIZE);
+    for (std::int64_t offset = 0; offset < size;) {
+        std::size_t chunk = static_cast<std::size_t>(std::min<std::int64_t>(size - offset, COMPARE_CHUNK_SIZE));
+        for (std::size_t filled = 0; filled < chunk;) {
+            std::size_t count = stream->read(std::span<std::byte>(expected.data() + filled, chunk - filled));
+            if (count == 0) {
+                return false;
+            }
+            filled += count;
+        }
+        input.readAt(offset, actual.data(), chunk);
+        if (std::memcmp(expected.data(), actual.data(), chunk) != 0) {
+            return false;
+        }
+        offset += static_cast<std::int64_t>(chunk);
+    }
+    return true;
+}
+
+void RDXWriter::addCatalog(const RDXCatalog& catalog) {
+    catalog_.merge(catalog);
+}
+
+void RDXWriter::addRawBlock(const RDXEntry& sourceEntry,
+                            std::span<const std::byte> block,
+                            const std::string& archivePath) {
+    if (block.size() != static_cast<std::size_t>(sourceEntry.blockSize)) {
+        throw std::invalid_argument("Raw block size does not match entry: " + sourceEntry.fileName);
+    }
+    
+    RDXEntry entry = sourceEntry;
+    entry.fileName = archivePath.empty() ? sourceEntry.fileName : archivePath;
+    entry.offset = currentOffset_;
+    writeBytes(block);
+    blockSizes_.emplace(entry.offset, entry.blockSize);
+    
+    entries_.push_back(std::move(entry));
+}
+
+void RDXWriter::addSharedEntry(const RDXEntry& existing, const std::string& archivePath) {
+    // Must point at a block of this archive, not of some other one
+    auto block = blockSizes_.find(existing.offset);
+    if (existing.kind == RDXEntryKind::BaseReference || block == blockSizes_.end() ||
+        block->second != existing.blockSize) {
+        throw std::invalid_argument("Shared entry does not refer to a block of this archive: " + existing.fileName);
+    }
+    
+    RDXEntry entry = existing;
+    entry.fileName = archivePath;
+    entries_.push_back(std::move(entry));
+}
+
+RDXDirectoryResult RDXWriter::addDirectory(const std::filesystem::path& directory,
+                                           CompressionEngine& engine,
+                                           const std::string& archivePrefix,
+                                           const DirectoryWalkOptions& walkOptions) {
+    if (!std::filesystem::is_directory(directory)) {
+        throw std::runtime_error("Not a directory: " + directory.string());
+    }
     
-    // Block magic (simplified - in production, use proper block markers)
-    std::uint32_t blockMagic = 0x424C4B01;  // "BLK" + version
-    file_.write(reinterpret_cast<const char*>(&blockMagic), sizeof(blockMagic));
+    std::filesystem::path root = directory.lexically_normal();
+    if (!root.has_filename()) {
+        root = root.parent_path();  // Trailing separator
+    }
+    
+    std::string prefix = archivePrefix;
+    if (prefix.empty()) {
+        std::filesystem::path name = std::filesystem::absolute(root).lexically_normal().filename();
+        if (name.empty()) {
+            name = std::filesystem::absolute(root).lexically_normal().parent_path().filename();
+        }
+        prefix = name.generic_string();
+    }
     
-    // Block header size
-    std::uint32_t headerSize = sizeof(std::uint32_t) + sizeof(std::uint32_t) +
-                               sizeof(std::int32_t) + sizeof(std::int32_t) +
-                               sizeof(std::int64_t) + sizeof(std::int64_t) + sizeof(std::int64_t) +
-                               sizeof(std::uint16_t);
-    file_.write(reinterpret_cast<const char*>(&headerSize), sizeof(headerSize));
+    RDXDirectoryResult result;
+    std::mutex failureMutex;
+    BlockingQueue<std::filesystem::path> discovered(DIRECTORY_QUEUE_CAPACITY);
+    std::exception_ptr walkError;
+    
+    std::thread walker([&] {
+        try {
+            walkDirectory(root, walkOptions,
+                          [&](const std::filesystem::path& file) { discovered.push(file); },
+                          [&](const std::filesystem::path& dir, const std::string& error) {
+                              std::lock_guard<std::mutex> lock(failureMutex);
+                              result.failures.push_back({dir, error});
+                          });
+        } catch (...) {
+            walkError = std::current_exception();
+        }
+        discovered.close();
+    });
+    
+    // Compression and the index are single-threaded; only discovery runs in parallel
+    while (auto file = discovered.pop()) {
+        std::string archivePath = file->lexically_relative(root).generic_string();
+        if (!prefix.empty()) {
+            archivePath = prefix + "/" + archivePath;
+        }
+        
+        try {
+            addFile(*file, engine, archivePath);
+            ++result.filesAdded;
+        } catch (const std::exception& e) {
+            std::lock_guard<std::mutex> lock(failureMutex);
+            result.failures.push_back({*file, e.what()});
+        }
+    }
+    
+    walker.join();
+    if (walkError) {
+        std::rethrow_exception(walkError);
+    }
+    
+    return result;
+}
+
+std::int64_t RDXWriter::writeBlock(RDXBlockHeader header, const ByteBuffer& structStream,
+                                   const ByteBuffer& residualStream) {
+    std::int64_t blockOffset = currentOffset_;
     
-    // Schema ID, File Type ID
-    file_.write(reinterpret_cast<const char*>(&schemaId), sizeof(schemaId));
-    file_.write(reinterpret_cast<const char*>(&fileTypeId), sizeof(fileTypeId));
+    header.compressedStructSize = static_cast<std::int64_t>(structStream.size());
+    header.compressedResidualSize = static_cast<std::int64_t>(residualStream.size());
     
-    // Sizes
-    std::int64_t structSize = static_cast<std::int64_t>(structStream.size());
-    std::int64_t residualSize = static_cast<std::int64_t>(residualStream.size());
-    file_.write(reinterpret_cast<const char*>(&originalSize), sizeof(originalSize));
-    file_.write(reinterpret_cast<const char*>(&structSize), sizeof(structSize));
-    file_.write(reinterpret_cast<const char*>(&residualSize), sizeof(residualSize));
+    // Checksum covers both streams exactly as stored
+    XXH64State streamHash;
+    streamHash.update(structStream.data());
+    streamHash.update(residualStream.data());
+    header.streamChecksum = streamHash.digest();
     
-    // Flags
-    std::uint16_t flags = 0;
-    file_.write(reinterpret_cast<const char*>(&flags), sizeof(flags));
+    writeBytes(encodeBlockHeader(header).data());
     
     // Write streams
     if (structStream.size() > 0) {
-        file_.write(reinterpret_cast<const char*>(structStream.dataPtr()), structStream.size());
+        writeBytes(structStream.data());
     }
     if (residualStream.size() > 0) {
-        file_.write(reinterpret_cast<const char*>(residualStream.dataPtr()), residualStream.size());
+        writeBytes(residualStream.data());
     }
     
-    currentOffset_ = file_.tellp();
     return blockOffset;
 }
 
 void RDXWriter::writeIndex() {
     std::int64_t indexOffset = currentOffset_;
     
+    // Serialize the whole index first so the sink sees a single write
+    ByteBuffer index;
+    
     // Write number of entries
     std::uint32_t entryCount = static_cast<std::uint32_t>(entries_.size());
-    file_.write(reinterpret_cast<const char*>(&entryCount), sizeof(entryCount));
+    index.append(&entryCount, sizeof(entryCount));
     
     // Write each entry
     for (const auto& entry : entries_) {
         // File name length and name
         std::uint32_t nameLen = static_cast<std::uint32_t>(entry.fileName.length());
-        file_.write(reinterpret_cast<const char*>(&nameLen), sizeof(nameLen));
-        file_.write(entry.fileName.c_str(), nameLen);
+        index.append(&nameLen, sizeof(nameLen));
+        index.append(entry.fileName.data(), nameLen);
         
         // Entry metadata
-        file_.write(reinterpret_cast<const char*>(&entry.originalSize), sizeof(entry.originalSize));
-        file_.write(reinterpret_cast<const char*>(&entry.compressedStructSize), sizeof(entry.compressedStructSize));
-        file_.write(reinterpret_cast<const char*>(&entry.compressedResidualSize), sizeof(entry.compressedResidualSize));
-        file_.write(reinterpret_cast<const char*>(&entry.schemaId), sizeof(entry.schemaId));
-        file_.write(reinterpret_cast<const char*>(&entry.fileTypeId), sizeof(entry.fileTypeId));
-        file_.write(reinterpret_cast<const char*>(&entry.offset), sizeof(entry.offset));
-        file_.write(reinterpret_cast<const char*>(&entry.blockSize), sizeof(entry.blockSize));
+        index.append(&entry.originalSize, sizeof(entry.originalSize));
+        index.append(&entry.compressedStructSize, sizeof(entry.compressedStructSize));
+        index.append(&entry.compressedResidualSize, sizeof(entry.compressedResidualSize));
+        index.append(&entry.schemaId, sizeof(entry.schemaId));
+        index.append(&entry.fileTypeId, sizeof(entry.fileTypeId));
+        index.append(&entry.offset, sizeof(entry.offset));
+        index.append(&entry.blockSize, sizeof(entry.blockSize));
+        
+        // Zero extents (format version 3)
+        std::uint32_t extentCount = static_cast<std::uint32_t>(entry.zeroExtents.size());
+        index.append(&extentCount, sizeof(extentCount));
+        for (const ZeroExtent& extent : entry.zeroExtents) {
+            index.append(&extent.offset, sizeof(extent.offset));
+            index.append(&extent.length, sizeof(extent.length));
+        }
+        
+        // Entry kind and base entry (format version 4)
+        std::uint8_t kind = static_cast<std::uint8_t>(entry.kind);
+        index.append(&kind, sizeof(kind));
+        if (entry.kind != RDXEntryKind::Block) {
+            std::uint32_t baseNameLen = static_cast<std::uint32_t>(entry.baseFileName.length());
+            index.append(&baseNameLen, sizeof(baseNameLen));
+            index.append(entry.baseFileName.data(), baseNameLen);
+            index.append(&entry.baseEntryIndex, sizeof(entry.baseEntryIndex));
+            index.append(&entry.baseContentChecksum, sizeof(entry.baseContentChecksum));
+        }
+    }
+    
+    // Delta base descriptor; an empty path means no base
+    std::uint32_t basePathLen = static_cast<std::uint32_t>(storedBasePath_.length());
+    index.append(&basePathLen, sizeof(basePathLen));
+    index.append(storedBasePath_.data(), basePathLen);
+    index.append(&baseIndexChecksum_, sizeof(baseIndexChecksum_));
+    
+    // Catalog (format version 5): only the records the entries refer to
+    auto appendString = [&](const std::string& value) {
+        std::uint32_t length = static_cast<std::uint32_t>(value.length());
+        index.append(&length, sizeof(length));
+        index.append(value.data(), length);
+    };
+    
+    std::map<int, const std::string*> fileTypes;
+    std::map<int, const RDXSchemaRecord*> schemas;
+    for (const auto& entry : entries_) {
+        auto fileType = catalog_.fileTypes.find(entry.fileTypeId);
+        if (fileType != catalog_.fileTypes.end()) {
+            fileTypes.emplace(fileType->first, &fileType->second);
+        }
+        auto schema = catalog_.schemas.find(entry.schemaId);
+        if (schema != catalog_.schemas.end()) {
+            schemas.emplace(schema->first, &schema->second);
+        }
+    }
+    
+    std::uint32_t fileTypeCount = static_cast<std::uint32_t>(fileTypes.size());
+    index.append(&fileTypeCount, sizeof(fileTypeCount));
+    for (const auto& [id, name] : fileTypes) {
+        std::int32_t fileTypeId = id;
+        index.append(&fileTypeId, sizeof(fileTypeId));
+        appendString(*name);
+    }
+    
+    std::uint32_t schemaCount = static_cast<std::uint32_t>(schemas.size());
+    index.append(&schemaCount, sizeof(schemaCount));
+    for (const auto& [id, schema] : schemas) {
+        std::int32_t schemaId = id;
+        std::int32_t version = schema->version;
+        index.append(&schemaId, sizeof(schemaId));
+        appendString(schema->name);
+        index.append(&version, sizeof(version));
+        appendString(schema->definition);
     }
     
-    // Update index offset in header
-    file_.seekp(sizeof(std::uint32_t) + sizeof(std::uint16_t) + sizeof(std::uint16_t));
-    file_.write(reinterpret_cast<const char*>(&indexOffset), sizeof(indexOffset));
+    writeBytes(index.data());
+    
+    if (streaming_) {
+        writeBytes(encodeArchiveFooter(indexOffset).data());
+    } else {
+        // Rewrite header with the index offset (and, when appending to an older
+        // or streaming archive, the current version and flags)
+        sink_->writeAt(0, encodeArchiveHeader(0, indexOffset).data());
+    }
 }
 
 void RDXWriter::finalize() {
-    if (!file_.is_open()) {
+    if (!sink_) {
         return;
     }
     
-    writeIndex();
-    file_.close();
+    // The archive itself is intact when LCM updates fail; finish it first
+    std::exception_ptr lcmError;
+    for (const auto& queue : lcmQueues_) {
+        try {
+            queue->flush();
+        } catch (...) {
+            if (!lcmError) {
+                lcmError = std::current_exception();
+            }
+        }
+    }
+    
+    // Release the sink even if writing the index fails, so the destructor
+    // does not try again
+    try {
+        writeIndex();
+        sink_->close();
+    } catch (...) {
+        sink_.reset();
+        throw;
+    }
+    sink_.reset();
+    
+    if (lcmError) {
+        std::rethrow_exception(lcmError);
+    }
 }
 
 } // namespace rdx::core
-
@@ -1,15 +1,37 @@
 #ifndef RDX_RDXWRITER_H
 #define RDX_RDXWRITER_H
 
+#include "container/ArchiveSink.h"
+#include "container/RDXFormat.h"
 #include "util/ByteBuffer.h"
+#include "util/DirectoryWalker.h"
+#include "util/ZeroExtents.h"
 #include "compression/CompressionEngine.h"
 #include <filesystem>
+#include <memory>
+#include <string>
 #include <vector>
-#include <fstream>
 #include <cstdint>
+#include <map>
+#include <unordered_map>
 
 namespace rdx::core {
 
+class DecompressionEngine;
+class RDXReader;
+
+enum class RDXOpenMode {
+    Create,  // Truncate the output and start a new archive
+    Append   // Keep existing blocks and add new ones after them
+};
+
+// Where an entry's content lives (format version 4)
+enum class RDXEntryKind : std::uint8_t {
+    Block = 0,          // Own block in this archive
+    BaseReference = 1,  // Identical to `baseFileName` in the base archive; no block
+    BaseDelta = 2       // Own block, compressed against `baseFileName` in the base archive
+};
+
 struct RDXEntry {
     std::string fileName;
     std::int64_t originalSize;
@@ -19,17 +41,117 @@ struct RDXEntry {
     int fileTypeId;
     std::int64_t offset;
     std::int64_t blockSize;
+    std::vector<ZeroExtent> zeroExtents;  // Sorted; not stored in the block (format version 3)
+    RDXEntryKind kind = RDXEntryKind::Block;
+    std::string baseFileName;             // Entry in the base archive for delta kinds
+    
+    // Delta kinds: position of the base entry in the base archive's index,
+    // since names need not be unique, and the XXH64 of its content, which the
+    // restored content is checked against
+    std::uint32_t baseEntryIndex = 0;
+    std::uint64_t baseContentChecksum = 0;
+};
+
+// Schema and file type tables embedded in the archive (format version 5), so
+// an archive describes its entries without the LCM database it was built with
+struct RDXSchemaRecord {
+    std::string name;
+    int version = 0;
+    std::string definition;  // SchemaRegistry::schemaToJSON
+};
+
+struct RDXCatalog {
+    std::map<int, std::string> fileTypes;    // fileTypeId -> name
+    std::map<int, RDXSchemaRecord> schemas;  // schemaId -> schema
+    
+    // Adds the records of `other` that are missing here. Throws if `other`
+    // has a different file type name, or schema name or version, under an ID
+    // present here: the archives were written with different LCM databases,
+    // whose IDs cannot be mixed in one archive.
+    void merge(const RDXCatalog& other);
+};
+
+struct RDXAddFailure {
+    std::filesystem::path path;
+    std::string error;
+};
+
+struct RDXDirectoryResult {
+    std::size_t filesAdded = 0;
+    std::vector<RDXAddFailure> failures;  // Files that failed and unreadable directories
+};
+
+struct RDXDeltaOptions {
+    // Changed files are compressed against their previous version (same path
+    // in the base) if that version is at most this large; 0 disables it.
+    // The previous version is held in memory while compressing.
+    std::int64_t maxPatchBaseSize = 512 * 1024 * 1024;
+    
+    // Base location recorded in the delta. Readers resolve relative paths
+    // against the delta archive's directory; defaults to the base's file name,
+    // i.e. the base is expected next to the delta.
+    std::string storedBasePath;
 };
 
 class RDXWriter {
 public:
-    explicit RDXWriter(const std::filesystem::path& outputPath);
+    explicit RDXWriter(const std::filesystem::path& outputPath,
+                       RDXOpenMode mode = RDXOpenMode::Create);
+    
+    // Writes a new archive to an arbitrary sink. Archives written to
+    // non-seekable sinks (pipes, sockets, uploaders) use the streaming layout:
+    // nothing is ever patched, the index offset goes into a trailing footer.
+    explicit RDXWriter(std::unique_ptr<ArchiveSink> sink);
+    
+    // Finalizes an archive that was not finalized explicitly; errors are
+    // only logged to stderr there
     ~RDXWriter();
     
     void addFile(const std::filesystem::path& inputPath,
                  CompressionEngine& engine,
                  const std::string& archivePath = "");
     
+    // Turns this into a delta archive against `basePath`. Files whose content
+    // matches a base entry (same size and XXH64, then compared byte for byte)
+    // are stored as references (no block), and changed files are compressed
+    // against their previous version (the last base entry under the same
+    // path), which `engine` reconstructs from the base. The base must stay
+    // unmodified for the delta to remain readable. Call before adding files.
+    void setDeltaBase(const std::filesystem::path& basePath,
+                      DecompressionEngine& engine,
+                      const RDXDeltaOptions& options = {});
+    
+    // Catalog records for entries added through addRawBlock/addSharedEntry;
+    // addFile records its own. Throws on records conflicting with the
+    // archive's (see RDXCatalog::merge).
+    void addCatalog(const RDXCatalog& catalog);
+    const RDXCatalog& getCatalog() const { return catalog_; }
+    
+    // Appends a block copied verbatim from another archive (see
+    // RDXReader::readRawBlock); nothing is decompressed or recompressed
+    void addRawBlock(const RDXEntry& sourceEntry,
+                     std::span<const std::byte> block,
+                     const std::string& archivePath = "");
+    
+    // Adds an index entry under `archivePath` that reuses the block of an
+    // entry already written to this archive (identical content stored once)
+    void addSharedEntry(const RDXEntry& existing, const std::string& archivePath);
+    
+    // Adds every regular file below `directory` as "<archivePrefix>/<relative
+    // path>" ('/'-separated); the prefix defaults to the directory's name.
+    // A parallel walker discovers files while the calling thread compresses
+    // the ones found so far, so archive order follows discovery order.
+    // Per-file failures are collected in the result instead of thrown.
+    RDXDirectoryResult addDirectory(const std::filesystem::path& directory,
+                                    CompressionEngine& engine,
+                                    const std::string& archivePrefix = "",
+                                    const DirectoryWalkOptions& walkOptions = {});
+    
+    // Writes the index and closes the output; throws if that fails. Also a
+    // barrier for write-behind LCM updates: waits until every
+    // CompressionEngine write queue used by addFile has been applied. If some
+    // of those updates failed, the archive is still completed and the LCM
+    // error is thrown afterwards
     void finalize();
     
     const std::vector<RDXEntry>& getEntries() const { return entries_; }
@@ -38,21 +160,34 @@ public:
     static std::uint32_t getMagic() { return RDX_MAGIC; }
 
 private:
-    std::filesystem::path outputPath_;
-    std::ofstream file_;
+    std::unique_ptr<ArchiveSink> sink_;
     std::vector<RDXEntry> entries_;
+    std::unordered_map<std::int64_t, std::int64_t> blockSizes_;  // Block offset -> size, for addSharedEntry
     std::int64_t currentOffset_;
+    bool streaming_;
+    
+    RDXCatalog catalog_;
+    std::vector<std::shared_ptr<LCMWriteQueue>> lcmQueues_;  // Flushed by finalize
     
-    static constexpr std::uint32_t RDX_MAGIC = 0x52445801;  // "RDX" + version
-    static constexpr std::uint16_t RDX_VERSION = 1;
+    // Delta mode
+    std::unique_ptr<RDXReader> base_;
+    DecompressionEngine* baseEngine_ = nullptr;
+    RDXDeltaOptions deltaOptions_;
+    std::string storedBasePath_;
+    std::uint64_t baseIndexChecksum_ = 0;
+    std::vector<RDXEntry> baseEntries_;
+    std::unordered_map<std::string, std::uint32_t> baseByName_;  // Last base entry for each path
+    std::map<std::pair<std::int64_t, std::uint64_t>, std::vector<std::uint32_t>> baseByContent_;  // (size, XXH64) -> base entries
     
+    void openForAppend(const std::filesystem::path& outputPath);
+    bool matchesBaseEntry(const std::filesystem::path& inputPath, const RDXEntry& baseEntry);
+    void writeBytes(std::span<const std::byte> data);
     void writeHeader();
     void writeIndex();
-    std::int64_t writeBlock(const ByteBuffer& structStream, const ByteBuffer& residualStream,
-                           int schemaId, int fileTypeId, std::int64_t originalSize);
+    std::int64_t writeBlock(RDXBlockHeader header, const ByteBuffer& structStream,
+                            const ByteBuffer& residualStream);
 };
 
 } // namespace rdx::core
 
 #endif // RDX_RDXWRITER_H
-
@@ -1,25 +1,202 @@
 #include "decompression/DecompressionEngine.h"
+#include "util/FileHandle.h"
+#include "util/HashUtils.h"
+#include "util/ParallelFor.h"
 #include <zstd.h>
-#include <fstream>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <vector>
 
 namespace rdx::core {
 
-DecompressionEngine::DecompressionEngine(LCMManager& lcm, SchemaRegistry& schemaRegistry)
-    : lcm_(lcm)
-    , schemaRegistry_(schemaRegistry) {
+namespace {
+
+// Output window of streaming decompression; together with zstd's own
+// decoding window this bounds memory per call
+constexpr std::size_t STREAM_WINDOW_SIZE = 1024 * 1024;
+
+using DCtxPtr = std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)>;
+
+DCtxPtr createDCtx(std::span<const std::byte> patchBase) {
+    DCtxPtr dctx(ZSTD_createDCtx(), &ZSTD_freeDCtx);
+    if (!dctx) {
+        throw std::runtime_error("ZSTD decompression failed: out of memory");
+    }
+    
+    if (!patchBase.empty()) {
+        // Patch-from frames use a window spanning the base, beyond the default limit
+        ZSTD_DCtx_setParameter(dctx.get(), ZSTD_d_windowLogMax, ZSTD_dParam_getBounds(ZSTD_d_windowLogMax).upperBound);
+        ZSTD_DCtx_refPrefix(dctx.get(), patchBase.data(), patchBase.size());
+    }
+    return dctx;
+}
+
+std::int64_t packedSizeOf(const RDXEntry& entry) {
+    return entry.originalSize - totalZeroBytes(entry.zeroExtents);
+}
+
+// Replaces consumed decoder input with the next piece; false at the end of the input
+using InputRefill = std::function<bool(ZSTD_inBuffer&)>;
+
+// Decodes a zstd stream of one or more frames through a fixed window, calling
+// onWindow per window; checks that exactly `expectedSize` bytes come out.
+// `input` is decoded first, then whatever `refill` supplies, if given.
+void streamFrames(ZSTD_DCtx* dctx,
+                  ZSTD_inBuffer input,
+                  const InputRefill& refill,
+                  std::int64_t expectedSize,
+                  const std::string& fileName,
+                  const std::function<void(std::span<const std::byte>)>& onWindow) {
+    std::vector<std::byte> window(STREAM_WINDOW_SIZE);
+    std::int64_t produced = 0;
+    std::size_t consumed = 0;
+    
+    // A frame can end on the call that fills the window; remember it, since
+    // the next call already reports the start of a further frame
+    bool atFrameEnd = false;
+    
+    while (true) {
+        ZSTD_outBuffer output{window.data(), window.size(), 0};
+        std::size_t inputBefore = input.pos;
+        std::size_t remaining = ZSTD_decompressStream(dctx, &output, &input);
+        if (ZSTD_isError(remaining)) {
+            throw std::runtime_error("ZSTD decompression failed: " + std::string(ZSTD_getErrorName(remaining)));
+        }
+        if (remaining == 0) {
+            atFrameEnd = true;
+        } else if (output.pos > 0 || input.pos != inputBefore) {
+            atFrameEnd = false;
+        }
+        
+        if (output.pos > 0) {
+            produced += static_cast<std::int64_t>(output.pos);
+            if (produced > expectedSize) {
+                throw std::runtime_error("Decompressed size does not match entry: " + fileName);
+            }
+            onWindow(std::span<const std::byte>(window.data(), output.pos));
+        }
+        
+        if (input.pos == input.size && output.pos < output.size) {
+            consumed += input.size;
+            if (refill && refill(input)) {
+                continue;
+            }
+            // All input consumed and the decoder has nothing left to flush;
+            // no input at all is an empty entry
+            if (!atFrameEnd && consumed > 0) {
+                throw std::runtime_error("ZSTD decompression failed: truncated stream for entry: " + fileName);
+            }
+            break;
+        }
+    }
+    
+    if (produced != expectedSize) {
+        throw std::runtime_error("Decompressed size does not match entry: " + fileName);
+    }
+}
+
+void streamFrames(ZSTD_DCtx* dctx,
+                  std::span<const std::byte> compressed,
+                  std::int64_t expectedSize,
+                  const std::string& fileName,
+                  const std::function<void(std::span<const std::byte>)>& onWindow) {
+    streamFrames(dctx, ZSTD_inBuffer{compressed.data(), compressed.size(), 0}, nullptr, expectedSize, fileName,
+                 onWindow);
+}
+
+// One frame of a multi-frame residual stream
+struct ResidualFrame {
+    std::span<const std::byte> data;
+    std::int64_t packedOffset;
+    std::int64_t contentSize;
+};
+
+// Locates the frames of a residual stream by walking their headers. Returns
+// an empty list, leaving the stream to the sequential path, unless every
+// frame records its content size and the sizes add up to `packedSize`.
+std::vector<ResidualFrame> listFrames(std::span<const std::byte> residual, std::int64_t packedSize) {
+    std::vector<ResidualFrame> frames;
+    std::int64_t packedOffset = 0;
+    
+    while (!residual.empty()) {
+        std::size_t frameSize = ZSTD_findFrameCompressedSize(residual.data(), residual.size());
+        unsigned long long contentSize = ZSTD_getFrameContentSize(residual.data(), residual.size());
+        if (ZSTD_isError(frameSize) || contentSize == ZSTD_CONTENTSIZE_UNKNOWN ||
+            contentSize == ZSTD_CONTENTSIZE_ERROR ||
+            contentSize > static_cast<unsigned long long>(packedSize - packedOffset)) {
+            return {};
+        }
+        
+        frames.push_back({residual.first(frameSize), packedOffset, static_cast<std::int64_t>(contentSize)});
+        packedOffset += static_cast<std::int64_t>(contentSize);
+        residual = residual.subspan(frameSize);
+    }
+    
+    if (packedOffset != packedSize) {
+        return {};
+    }
+    return frames;
+}
+
+// Input chunk requested from a decoder's source at a time
+constexpr std::size_t DECODER_INPUT_SIZE = 128 * 1024;
+
+FileHandle openOutputFile(const RDXEntry& entry, const std::filesystem::path& outputPath) {
+    FileHandle file;
+    try {
+        file = FileHandle(outputPath, FileHandle::Mode::Write);
+    } catch (const std::exception&) {
+        throw std::runtime_error("Failed to open output file: " + outputPath.string());
+    }
+    
+    if (!entry.zeroExtents.empty()) {
+        file.markSparse();
+    }
+    return file;
+}
+
+const std::array<std::byte, 64 * 1024> ZEROS{};
+
+// Feeds `length` zero bytes to the sink in bounded pieces
+void emitZeros(const ContentSink& sink, std::int64_t length) {
+    while (length > 0) {
+        std::size_t piece = static_cast<std::size_t>(std::min<std::int64_t>(length, ZEROS.size()));
+        sink(std::span<const std::byte>(ZEROS.data(), piece));
+        length -= static_cast<std::int64_t>(piece);
+    }
+}
+
+} // namespace
+
+DecompressionEngine::DecompressionEngine()
+    : frameThreadCount_(0) {
+}
+
+void DecompressionEngine::setFrameThreadCount(unsigned threadCount) {
+    frameThreadCount_ = threadCount;
 }
 
 void DecompressionEngine::decompressWithZstd(std::span<const std::byte> compressed,
                                               std::size_t originalSize,
-                                              ByteBuffer& out) {
+                                              ByteBuffer& out,
+                                              std::span<const std::byte> patchBase) {
     out.resize(originalSize);
     
-    std::size_t decompressedSize = ZSTD_decompress(
-        out.mutableDataPtr(),
-        originalSize,
-        compressed.data(),
-        compressed.size()
-    );
+    std::size_t decompressedSize;
+    if (patchBase.empty()) {
+        decompressedSize = ZSTD_decompress(
+            out.mutableDataPtr(),
+            originalSize,
+            compressed.data(),
+            compressed.size()
+        );
+    } else {
+        DCtxPtr dctx = createDCtx(patchBase);
+        decompressedSize = ZSTD_decompressDCtx(dctx.get(), out.mutableDataPtr(), originalSize,
+                                               compressed.data(), compressed.size());
+    }
     
     if (ZSTD_isError(decompressedSize)) {
         throw std::runtime_error("ZSTD decompression failed: " + std::string(ZSTD_getErrorName(decompressedSize)));
@@ -28,27 +205,338 @@ void DecompressionEngine::decompressWithZstd(std::span<const std::byte> compress
     out.resize(decompressedSize);
 }
 
+void DecompressionEngine::decompressStreaming(const RDXEntry& entry,
+                                               std::span<const std::byte> residualStream,
+                                               std::span<const std::byte> patchBase,
+                                               const std::function<void(std::span<const std::byte>)>& onWindow) {
+    std::int64_t packedSize = packedSizeOf(entry);
+    if (packedSize == 0 && residualStream.empty()) {
+        return;
+    }
+    
+    DCtxPtr dctx = createDCtx(patchBase);
+    streamFrames(dctx.get(), residualStream, packedSize, entry.fileName, onWindow);
+}
+
+void DecompressionEngine::decompressToFile(const RDXEntry& entry,
+                                            std::span<const std::byte> structStream,
+                                            std::span<const std::byte> residualStream,
+                                            const std::filesystem::path& outputPath,
+                                            std::span<const std::byte> patchBase) {
+    (void)structStream;  // Simplified format: the residual stream carries the content
+    
+    FileHandle file = openOutputFile(entry, outputPath);
+    
+    std::vector<ResidualFrame> frames;
+    if (patchBase.empty()) {
+        frames = listFrames(residualStream, packedSizeOf(entry));
+    }
+    if (frames.size() > 1) {
+        // Size the file up front and let each frame write its own range;
+        // zero extents are never written and stay holes
+        file.resize(entry.originalSize);
+        parallelFor(frames.size(), frameThreadCount_, [&](std::size_t i) {
+            const ResidualFrame& frame = frames[i];
+            PackedContentCursor cursor(entry.zeroExtents, entry.originalSize, frame.packedOffset);
+            DCtxPtr dctx = createDCtx({});
+            streamFrames(dctx.get(), frame.data, frame.contentSize, entry.fileName, [&](std::span<const std::byte> window) {
+                cursor.advance(window, [&](std::int64_t offset, std::span<const std::byte> bytes) {
+                    file.writeAt(offset, bytes.data(), bytes.size());
+                });
+            });
+        });
+        return;
+    }
+    
+    PackedContentCursor cursor(entry.zeroExtents, entry.originalSize);
+    decompressStreaming(entry, residualStream, patchBase, [&](std::span<const std::byte> window) {
+        cursor.advance(window, [&](std::int64_t offset, std::span<const std::byte> bytes) {
+            file.writeAt(offset, bytes.data(), bytes.size());
+        });
+    });
+    
+    // Extending past the last write leaves a trailing hole
+    if (file.size() != entry.originalSize) {
+        file.resize(entry.originalSize);
+    }
+}
+
 void DecompressionEngine::decompressToFile(const RDXEntry& entry,
-                                            const ByteBuffer& structStream,
-                                            const ByteBuffer& residualStream,
-                                            const std::filesystem::path& outputPath) {
+                                            const CompressedSource& residualSource,
+                                            const std::filesystem::path& outputPath,
+                                            std::span<const std::byte> patchBase) {
+    FileHandle file = openOutputFile(entry, outputPath);
+    
+    std::vector<std::byte> input(DECODER_INPUT_SIZE);
+    InputRefill refill = [&](ZSTD_inBuffer& buffer) {
+        std::size_t count = residualSource(input);
+        if (count > input.size()) {
+            throw std::runtime_error("Compressed source returned more bytes than requested");
+        }
+        buffer = {input.data(), count, 0};
+        return count > 0;
+    };
+    
+    PackedContentCursor cursor(entry.zeroExtents, entry.originalSize);
+    auto writeWindow = [&](std::span<const std::byte> window) {
+        cursor.advance(window, [&](std::int64_t offset, std::span<const std::byte> bytes) {
+            file.writeAt(offset, bytes.data(), bytes.size());
+        });
+    };
+    
+    DCtxPtr dctx = createDCtx(patchBase);
+    streamFrames(dctx.get(), ZSTD_inBuffer{input.data(), 0, 0}, refill, packedSizeOf(entry), entry.fileName,
+                 writeWindow);
+    
+    // Extending past the last write leaves a trailing hole
+    if (file.size() != entry.originalSize) {
+        file.resize(entry.originalSize);
+    }
+}
+
+void DecompressionEngine::decompressToBuffer(const RDXEntry& entry,
+                                              std::span<const std::byte> structStream,
+                                              std::span<const std::byte> residualStream,
+                                              ByteBuffer& out,
+                                              std::span<const std::byte> patchBase) {
     // For now, simplified decompression: just decompress residual stream
     // In production, reconstruct from structural stream using schema and constraints
     
-    ByteBuffer decompressed;
+    decompressPacked(entry, structStream, residualStream, out, patchBase);
+    restoreZeroExtents(out, entry.zeroExtents, entry.originalSize);
+}
+
+void DecompressionEngine::decompressPacked(const RDXEntry& entry,
+                                            std::span<const std::byte> structStream,
+                                            std::span<const std::byte> residualStream,
+                                            ByteBuffer& out,
+                                            std::span<const std::byte> patchBase) {
+    (void)structStream;
     
-    // Decompress residual (which contains the full file in simplified version)
-    decompressWithZstd(residualStream.data(), static_cast<std::size_t>(entry.originalSize), decompressed);
+    // Decompress residual (which contains the full file, minus zero extents,
+    // in simplified version)
+    std::size_t packedSize = static_cast<std::size_t>(packedSizeOf(entry));
+    if (packedSize == 0 && residualStream.empty()) {
+        out.resize(0);
+        return;
+    }
     
-    // Write to file
-    std::ofstream file(outputPath, std::ios::binary);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open output file: " + outputPath.string());
+    std::vector<ResidualFrame> frames;
+    if (patchBase.empty()) {
+        frames = listFrames(residualStream, static_cast<std::int64_t>(packedSize));
+    }
+    if (frames.size() > 1) {
+        out.resize(packedSize);
+        parallelFor(frames.size(), frameThreadCount_, [&](std::size_t i) {
+            const ResidualFrame& frame = frames[i];
+            std::size_t frameSize = static_cast<std::size_t>(frame.contentSize);
+            std::size_t decoded = ZSTD_decompress(out.mutableDataPtr() + frame.packedOffset, frameSize,
+                                                  frame.data.data(), frame.data.size());
+            if (ZSTD_isError(decoded)) {
+                throw std::runtime_error("ZSTD decompression failed: " + std::string(ZSTD_getErrorName(decoded)));
+            }
+            if (decoded != frameSize) {
+                throw std::runtime_error("Decompressed size does not match entry: " + entry.fileName);
+            }
+        });
+        return;
+    }
+    
+    decompressWithZstd(residualStream, packedSize, out, patchBase);
+    
+    if (out.size() != packedSize) {
+        throw std::runtime_error("Decompressed size does not match entry: " + entry.fileName);
     }
+}
+
+void DecompressionEngine::decompressToSink(const RDXEntry& entry,
+                                            std::span<const std::byte> structStream,
+                                            std::span<const std::byte> residualStream,
+                                            const ContentSink& sink,
+                                            std::span<const std::byte> patchBase) {
+    (void)structStream;
     
-    file.write(reinterpret_cast<const char*>(decompressed.dataPtr()), decompressed.size());
-    file.close();
+    // Zero extents are emitted as zeros without being materialized
+    std::int64_t emitted = 0;
+    PackedContentCursor cursor(entry.zeroExtents, entry.originalSize);
+    decompressStreaming(entry, residualStream, patchBase, [&](std::span<const std::byte> window) {
+        cursor.advance(window, [&](std::int64_t offset, std::span<const std::byte> bytes) {
+            emitZeros(sink, offset - emitted);
+            sink(bytes);
+            emitted = offset + static_cast<std::int64_t>(bytes.size());
+        });
+    });
+    emitZeros(sink, entry.originalSize - emitted);
 }
 
-} // namespace rdx::core
+std::size_t DecompressionEngine::decompressInto(const RDXEntry& entry,
+                                                std::span<const std::byte> structStream,
+                                                std::span<const std::byte> residualStream,
+                                                std::span<std::byte> out,
+                                                std::span<const std::byte> patchBase) {
+    if (static_cast<std::int64_t>(out.size()) < entry.originalSize) {
+        throw std::runtime_error("Output buffer too small for entry: " + entry.fileName);
+    }
+    
+    std::size_t written = 0;
+    decompressToSink(entry, structStream, residualStream, [&](std::span<const std::byte> bytes) {
+        std::memcpy(out.data() + written, bytes.data(), bytes.size());
+        written += bytes.size();
+    }, patchBase);
+    return written;
+}
+
+std::uint64_t DecompressionEngine::computeContentChecksum(const RDXEntry& entry,
+                                                         std::span<const std::byte> structStream,
+                                                         std::span<const std::byte> residualStream,
+                                                         std::span<const std::byte> patchBase) {
+    XXH64State hash;
+    decompressToSink(entry, structStream, residualStream, [&](std::span<const std::byte> bytes) {
+        hash.update(bytes);
+    }, patchBase);
+    return hash.digest();
+}
 
+struct EntryDecoder::State {
+    RDXEntry entry;
+    CompressedSource source;
+    ByteBuffer patchBase;
+    DCtxPtr dctx{nullptr, &ZSTD_freeDCtx};
+    
+    std::vector<std::byte> input;
+    ZSTD_inBuffer inBuffer{nullptr, 0, 0};
+    bool sourceEnded = false;
+    std::size_t lastResult = 0;  // Last ZSTD_decompressStream hint; 0 at a frame boundary
+    
+    std::int64_t position = 0;
+    std::size_t nextExtent = 0;
+    bool finished = false;
+    
+    void refill() {
+        if (inBuffer.pos < inBuffer.size || sourceEnded) {
+            return;
+        }
+        std::size_t count = source(input);
+        if (count > input.size()) {
+            throw std::runtime_error("Compressed source returned more bytes than requested");
+        }
+        sourceEnded = count == 0;
+        inBuffer = {input.data(), count, 0};
+    }
+};
+
+std::unique_ptr<EntryDecoder> DecompressionEngine::openDecoder(const RDXEntry& entry,
+                                                               CompressedSource source,
+                                                               ByteBuffer patchBase) {
+    auto state = std::make_unique<EntryDecoder::State>();
+    state->entry = entry;
+    state->source = std::move(source);
+    state->patchBase = std::move(patchBase);
+    state->dctx = createDCtx(state->patchBase.data());
+    state->input.resize(DECODER_INPUT_SIZE);
+    return std::unique_ptr<EntryDecoder>(new EntryDecoder(std::move(state)));
+}
+
+EntryDecoder::EntryDecoder(std::unique_ptr<State> state)
+    : state_(std::move(state)) {
+}
+
+EntryDecoder::~EntryDecoder() = default;
+
+std::int64_t EntryDecoder::size() const {
+    return state_->entry.originalSize;
+}
+
+std::int64_t EntryDecoder::position() const {
+    return state_->position;
+}
+
+std::size_t EntryDecoder::read(std::span<std::byte> out) {
+    State& s = *state_;
+    const std::vector<ZeroExtent>& extents = s.entry.zeroExtents;
+    
+    std::size_t total = 0;
+    while (total < out.size() && s.position < s.entry.originalSize) {
+        while (s.nextExtent < extents.size() &&
+               extents[s.nextExtent].offset + extents[s.nextExtent].length <= s.position) {
+            ++s.nextExtent;
+        }
+        
+        std::size_t wanted = out.size() - total;
+        if (s.nextExtent < extents.size() && extents[s.nextExtent].offset <= s.position) {
+            // Inside a zero extent: nothing to decode
+            const ZeroExtent& extent = extents[s.nextExtent];
+            std::size_t length = static_cast<std::size_t>(
+                std::min<std::int64_t>(extent.offset + extent.length - s.position, wanted));
+            std::memset(out.data() + total, 0, length);
+            total += length;
+            s.position += static_cast<std::int64_t>(length);
+            continue;
+        }
+        
+        std::int64_t segmentEnd = s.nextExtent < extents.size() ? extents[s.nextExtent].offset : s.entry.originalSize;
+        std::size_t length = static_cast<std::size_t>(std::min<std::int64_t>(segmentEnd - s.position, wanted));
+        decode(out.data() + total, length);
+        total += length;
+        s.position += static_cast<std::int64_t>(length);
+    }
+    
+    if (s.position == s.entry.originalSize && !s.finished) {
+        finish();
+    }
+    return total;
+}
+
+void EntryDecoder::decode(std::byte* out, std::size_t length) {
+    State& s = *state_;
+    ZSTD_outBuffer outBuffer{out, length, 0};
+    
+    while (outBuffer.pos < outBuffer.size) {
+        s.refill();
+        if (s.inBuffer.pos == s.inBuffer.size && s.sourceEnded && s.lastResult == 0) {
+            // Input ended at a frame boundary before the content did
+            throw std::runtime_error("Decompressed size does not match entry: " + s.entry.fileName);
+        }
+        
+        std::size_t inBefore = s.inBuffer.pos;
+        std::size_t outBefore = outBuffer.pos;
+        s.lastResult = ZSTD_decompressStream(s.dctx.get(), &outBuffer, &s.inBuffer);
+        if (ZSTD_isError(s.lastResult)) {
+            throw std::runtime_error("ZSTD decompression failed: " + std::string(ZSTD_getErrorName(s.lastResult)));
+        }
+        
+        if (s.inBuffer.pos == inBefore && outBuffer.pos == outBefore && s.sourceEnded) {
+            throw std::runtime_error("ZSTD decompression failed: truncated stream for entry: " + s.entry.fileName);
+        }
+    }
+}
+
+void EntryDecoder::finish() {
+    State& s = *state_;
+    s.finished = true;
+    
+    // The frame must end exactly here: drain what is left of the input and
+    // make sure it yields no further content
+    std::byte extra;
+    while (true) {
+        s.refill();
+        if (s.inBuffer.pos == s.inBuffer.size && s.sourceEnded) {
+            break;
+        }
+        
+        ZSTD_outBuffer outBuffer{&extra, 1, 0};
+        s.lastResult = ZSTD_decompressStream(s.dctx.get(), &outBuffer, &s.inBuffer);
+        if (ZSTD_isError(s.lastResult)) {
+            throw std::runtime_error("ZSTD decompression failed: " + std::string(ZSTD_getErrorName(s.lastResult)));
+        }
+        if (outBuffer.pos > 0) {
+            throw std::runtime_error("Decompressed size does not match entry: " + s.entry.fileName);
+        }
+    }
+    
+    if (s.lastResult != 0) {
+        throw std::runtime_error("ZSTD decompression failed: truncated stream for entry: " + s.entry.fileName);
+    }
+}
+
+} // namespace rdx::core
@@ -1,30 +1,142 @@
 #ifndef RDX_DECOMPRESSIONENGINE_H
 #define RDX_DECOMPRESSIONENGINE_H
 
-#include "lcm/LCMManager.h"
-#include "schemas/SchemaRegistry.h"
 #include "container/RDXWriter.h"
 #include "util/ByteBuffer.h"
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <span>
 
 namespace rdx::core {
 
+// Supplies compressed bytes: fills the buffer and returns the count, 0 at the end
+using CompressedSource = std::function<std::size_t(std::span<std::byte>)>;
+
+// Receives reconstructed content, in order
+using ContentSink = std::function<void(std::span<const std::byte>)>;
+
+// Pull-based decoder of one entry (see DecompressionEngine::openDecoder).
+// Memory is bounded by zstd's window and one input chunk.
+class EntryDecoder {
+public:
+    ~EntryDecoder();
+    
+    EntryDecoder(const EntryDecoder&) = delete;
+    EntryDecoder& operator=(const EntryDecoder&) = delete;
+    
+    // Fills `out` with the next content bytes, zero extents included, and
+    // returns the count; 0 once the whole entry has been read. Reaching the
+    // end also checks that the compressed input ends with the content.
+    std::size_t read(std::span<std::byte> out);
+    
+    std::int64_t size() const;
+    std::int64_t position() const;
+
+private:
+    friend class DecompressionEngine;
+    struct State;
+    
+    explicit EntryDecoder(std::unique_ptr<State> state);
+    
+    std::unique_ptr<State> state_;
+    
+    void decode(std::byte* out, std::size_t length);
+    void finish();
+};
+
 class DecompressionEngine {
 public:
-    DecompressionEngine(LCMManager& lcm, SchemaRegistry& schemaRegistry);
+    // Archives embed the schema and file type tables their entries need (see
+    // RDXReader::getCatalog), so decompression never has to open the LCM and
+    // the engine takes no LCMManager or SchemaRegistry.
+    DecompressionEngine();
+    
+    // Entries stored as several zstd frames are decoded frame-parallel by
+    // decompressToFile and decompressPacked on up to this many threads
+    // (0 = one per hardware thread, 1 = sequential). With 0, entries decoded
+    // on the workers of a parallel extraction (RDXReader::extractMany,
+    // verifyArchive) are decoded sequentially, as those already use every
+    // hardware thread. Set before use.
+    void setFrameThreadCount(unsigned threadCount);
+    
+    // Keeps no per-call state, so one engine may serve several extraction threads.
+    // Streams through a fixed output window, writing each window as it is
+    // produced, so memory stays bounded whatever the entry size.
+    // Zero extents of the entry become holes in the output file.
+    // Entries compressed against a patch base (delta archives) need the same
+    // base content passed as `patchBase`.
+    void decompressToFile(const RDXEntry& entry,
+                          std::span<const std::byte> structStream,
+                          std::span<const std::byte> residualStream,
+                          const std::filesystem::path& outputPath,
+                          std::span<const std::byte> patchBase = {});
     
+    // Like decompressToFile, but the compressed residual stream is requested
+    // from `residualSource` in bounded chunks rather than held in memory, so
+    // the input is never loaded whole. Frames are decoded sequentially.
     void decompressToFile(const RDXEntry& entry,
-                          const ByteBuffer& structStream,
-                          const ByteBuffer& residualStream,
-                          const std::filesystem::path& outputPath);
+                          const CompressedSource& residualSource,
+                          const std::filesystem::path& outputPath,
+                          std::span<const std::byte> patchBase = {});
+    
+    // Reconstructs the entry into `out` (resized to the original size)
+    void decompressToBuffer(const RDXEntry& entry,
+                            std::span<const std::byte> structStream,
+                            std::span<const std::byte> residualStream,
+                            ByteBuffer& out,
+                            std::span<const std::byte> patchBase = {});
+    
+    // Like decompressToBuffer, but leaves out the entry's zero extents: `out`
+    // receives only the stored bytes, in order (see writeWithHoles)
+    void decompressPacked(const RDXEntry& entry,
+                          std::span<const std::byte> structStream,
+                          std::span<const std::byte> residualStream,
+                          ByteBuffer& out,
+                          std::span<const std::byte> patchBase = {});
+    
+    // Delivers the content to `sink` window by window, zero extents as runs of
+    // zeros; for serving entries without a temporary file
+    void decompressToSink(const RDXEntry& entry,
+                          std::span<const std::byte> structStream,
+                          std::span<const std::byte> residualStream,
+                          const ContentSink& sink,
+                          std::span<const std::byte> patchBase = {});
+    
+    // Reconstructs the entry into caller-provided memory of at least the
+    // original size; returns the number of bytes written
+    std::size_t decompressInto(const RDXEntry& entry,
+                               std::span<const std::byte> structStream,
+                               std::span<const std::byte> residualStream,
+                               std::span<std::byte> out,
+                               std::span<const std::byte> patchBase = {});
+    
+    // Pull-based counterpart: compressed residual bytes are requested from
+    // `source` as the caller reads. The decoder keeps `patchBase` alive.
+    std::unique_ptr<EntryDecoder> openDecoder(const RDXEntry& entry,
+                                              CompressedSource source,
+                                              ByteBuffer patchBase = {});
+    
+    // Returns the XXH64 of the reconstructed content, streamed like decompressToFile
+    std::uint64_t computeContentChecksum(const RDXEntry& entry,
+                                         std::span<const std::byte> structStream,
+                                         std::span<const std::byte> residualStream,
+                                         std::span<const std::byte> patchBase = {});
 
 private:
-    LCMManager& lcm_;
-    SchemaRegistry& schemaRegistry_;
+    unsigned frameThreadCount_;
     
     void decompressWithZstd(std::span<const std::byte> compressed, 
                             std::size_t originalSize,
-                            ByteBuffer& out);
+                            ByteBuffer& out,
+                            std::span<const std::byte> patchBase = {});
+    
+    // Decompresses the packed content window by window, calling onWindow with
+    // each piece in order; checks that exactly the packed size comes out
+    void decompressStreaming(const RDXEntry& entry,
+                             std::span<const std::byte> residualStream,
+                             std::span<const std::byte> patchBase,
+                             const std::function<void(std::span<const std::byte>)>& onWindow);
 };
 
 } // namespace rdx::core
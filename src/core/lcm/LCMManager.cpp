@@ -4,7 +4,13 @@
 #include <sqlite3.h>
 #include <stdexcept>
 #include <algorithm>
+#include <bit>
+#include <condition_variable>
+#include <map>
 #include <sstream>
+#include <string_view>
+#include <thread>
+#include <utility>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -17,7 +23,490 @@
 
 namespace rdx::core {
 
-std::unique_ptr<LCMManager> LCMManager::createDefault() {
+namespace {
+
+// Leaves a cached statement reset and unbound when the call is done,
+// whichever way it exits
+class StatementScope {
+public:
+    explicit StatementScope(sqlite3_stmt* stmt) : stmt_(stmt) {}
+    ~StatementScope() {
+        sqlite3_reset(stmt_);
+        sqlite3_clear_bindings(stmt_);
+    }
+    
+    StatementScope(const StatementScope&) = delete;
+    StatementScope& operator=(const StatementScope&) = delete;
+    
+    sqlite3_stmt* get() const { return stmt_; }
+
+private:
+    sqlite3_stmt* stmt_;
+};
+
+// meta.schema_version written by this build; older databases are migrated
+// on open (see migrateSchema)
+constexpr int LCM_SCHEMA_VERSION = 4;
+
+// computeSHA256 hashes are 64 lowercase hex digits, left-padded with zeros.
+// They are stored as a BLOB of their bytes with the leading zero bytes
+// dropped, and padded back out when read. Anything else (hand-written keys)
+// is stored as TEXT unchanged, so every value round-trips exactly.
+constexpr std::size_t HEX_HASH_DIGITS = 64;
+
+int hexDigitValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+bool encodeHash(std::string_view hex, std::vector<unsigned char>& out) {
+    if (hex.size() != HEX_HASH_DIGITS) {
+        return false;
+    }
+    out.clear();
+    for (std::size_t i = 0; i < hex.size(); i += 2) {
+        int high = hexDigitValue(hex[i]);
+        int low = hexDigitValue(hex[i + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        if (!out.empty() || high != 0 || low != 0) {
+            out.push_back(static_cast<unsigned char>((high << 4) | low));
+        }
+    }
+    return true;
+}
+
+void bindHash(sqlite3_stmt* stmt, int index, const std::string& hash) {
+    std::vector<unsigned char> bytes;
+    if (encodeHash(hash, bytes)) {
+        // Never a zero-length BLOB: sqlite3_bind_blob would store NULL for nullptr
+        static const unsigned char zero = 0;
+        const unsigned char* data = bytes.empty() ? &zero : bytes.data();
+        sqlite3_bind_blob(stmt, index, data, bytes.empty() ? 0 : static_cast<int>(bytes.size()), SQLITE_TRANSIENT);
+    } else {
+        sqlite3_bind_text(stmt, index, hash.c_str(), static_cast<int>(hash.size()), SQLITE_TRANSIENT);
+    }
+}
+
+std::string readHash(sqlite3_stmt* stmt, int column) {
+    switch (sqlite3_column_type(stmt, column)) {
+        case SQLITE_NULL:
+            return "";
+        case SQLITE_BLOB: {
+            static const char digits[] = "0123456789abcdef";
+            const auto* bytes = static_cast<const unsigned char*>(sqlite3_column_blob(stmt, column));
+            int size = sqlite3_column_bytes(stmt, column);
+            std::size_t byteDigits = 2 * static_cast<std::size_t>(size);
+            std::string hex(byteDigits < HEX_HASH_DIGITS ? HEX_HASH_DIGITS - byteDigits : 0, '0');
+            for (int i = 0; i < size; ++i) {
+                hex.push_back(digits[bytes[i] >> 4]);
+                hex.push_back(digits[bytes[i] & 0xF]);
+            }
+            return hex;
+        }
+        default:
+            return reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+    }
+}
+
+// rdx_hash_blob(text): the stored form of a hash, for migrating TEXT columns
+void hashBlobFunction(sqlite3_context* context, int, sqlite3_value** args) {
+    if (sqlite3_value_type(args[0]) != SQLITE_TEXT) {
+        sqlite3_result_value(context, args[0]);
+        return;
+    }
+    std::string_view text(reinterpret_cast<const char*>(sqlite3_value_text(args[0])),
+                          static_cast<std::size_t>(sqlite3_value_bytes(args[0])));
+    std::vector<unsigned char> bytes;
+    if (!encodeHash(text, bytes)) {
+        sqlite3_result_value(context, args[0]);
+    } else if (bytes.empty()) {
+        sqlite3_result_zeroblob(context, 0);
+    } else {
+        sqlite3_result_blob(context, bytes.data(), static_cast<int>(bytes.size()), SQLITE_TRANSIENT);
+    }
+}
+
+// Rows per multi-row chunk INSERT: 8 parameters each, well under
+// SQLite's historical 999-parameter limit
+constexpr std::size_t CHUNK_INSERT_ROWS = 64;
+constexpr int CHUNK_COLUMNS = 8;
+
+constexpr std::size_t DEFAULT_CHUNK_BATCH_SIZE = 8192;
+
+// LSH over SimHash signatures: LSH_BANDS bands of 16 bits, keyed as
+// (band << 16) | bits. Two signatures within LSH_BANDS - 1 bits of each
+// other agree on at least one whole band (pigeonhole).
+constexpr int LSH_BAND_BITS = 64 / LCMManager::LSH_BANDS;
+
+std::int64_t lshBandKey(std::uint64_t signature, int band) {
+    std::uint64_t bits = (signature >> (band * LSH_BAND_BITS)) & ((std::uint64_t(1) << LSH_BAND_BITS) - 1);
+    return static_cast<std::int64_t>((static_cast<std::uint64_t>(band) << LSH_BAND_BITS) | bits);
+}
+
+struct DurabilityPragmas {
+    const char* synchronous;
+    std::int64_t mmapSize;     // Bytes; 0 disables memory-mapped I/O
+    int cacheSizeKiB;
+    const char* tempStore;
+    int busyTimeoutMs;
+};
+
+DurabilityPragmas pragmasFor(LCMDurability durability) {
+    switch (durability) {
+        case LCMDurability::Safe:
+            return {"FULL", 0, 2 * 1024, "DEFAULT", 10000};
+        case LCMDurability::Ingest:
+            return {"OFF", std::int64_t(1) << 30, 256 * 1024, "MEMORY", 30000};
+        case LCMDurability::Balanced:
+        default:
+            return {"NORMAL", std::int64_t(256) << 20, 32 * 1024, "MEMORY", 5000};
+    }
+}
+
+std::string queryPragma(sqlite3* db, const char* name) {
+    std::string value;
+    sqlite3_stmt* stmt = nullptr;
+    std::string sql = std::string("PRAGMA ") + name;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+    }
+    sqlite3_finalize(stmt);
+    return value;
+}
+
+// Whether other connections can read while this one writes
+bool isWalMode(sqlite3* db) {
+    return queryPragma(db, "journal_mode") == "wal";
+}
+
+LCMConnectionSettings readConnectionSettings(sqlite3* db) {
+    LCMConnectionSettings settings;
+    settings.journalMode = queryPragma(db, "journal_mode");
+    settings.synchronous = std::stoi(queryPragma(db, "synchronous"));
+    settings.cacheSize = std::stoll(queryPragma(db, "cache_size"));
+    settings.mmapSize = std::stoll(queryPragma(db, "mmap_size"));
+    settings.tempStore = std::stoi(queryPragma(db, "temp_store"));
+    return settings;
+}
+
+// Upsert on the unique chunk_hash: a chunk seen before only adds to its
+// seen_count. RETURNING gives the id of every row, inserted or updated
+// (in no particular order, hence the hash).
+std::string chunkInsertSql(std::size_t rows) {
+    std::string sql = "INSERT INTO chunk_index (file_id, offset_bytes, length_bytes, chunk_hash, "
+                      "chunk_fingerprint, schema_id, token_profile_id, seen_count) VALUES ";
+    for (std::size_t i = 0; i < rows; ++i) {
+        sql += (i == 0) ? "(?, ?, ?, ?, ?, ?, ?, ?)" : ", (?, ?, ?, ?, ?, ?, ?, ?)";
+    }
+    sql += " ON CONFLICT(chunk_hash) DO UPDATE SET seen_count = seen_count + excluded.seen_count"
+           " RETURNING chunk_id, chunk_hash, seen_count";
+    return sql;
+}
+
+std::string occurrenceInsertSql(std::size_t rows) {
+    std::string sql = "INSERT OR REPLACE INTO chunk_occurrences (file_id, offset_bytes, chunk_id) VALUES ";
+    for (std::size_t i = 0; i < rows; ++i) {
+        sql += (i == 0) ? "(?, ?, ?)" : ", (?, ?, ?)";
+    }
+    return sql;
+}
+
+void bindChunk(sqlite3_stmt* stmt, int firstParam, const FileChunkInfo& chunk) {
+    sqlite3_bind_int(stmt, firstParam, chunk.fileId);
+    sqlite3_bind_int64(stmt, firstParam + 1, chunk.offsetBytes);
+    sqlite3_bind_int64(stmt, firstParam + 2, chunk.lengthBytes);
+    bindHash(stmt, firstParam + 3, chunk.chunkHash);
+    sqlite3_bind_int64(stmt, firstParam + 4, static_cast<std::int64_t>(chunk.chunkFingerprint));
+    sqlite3_bind_int(stmt, firstParam + 5, chunk.schemaId);
+    if (chunk.tokenProfileId.has_value()) {
+        sqlite3_bind_int(stmt, firstParam + 6, chunk.tokenProfileId.value());
+    } else {
+        sqlite3_bind_null(stmt, firstParam + 6);
+    }
+    sqlite3_bind_int64(stmt, firstParam + 7, chunk.seenCount);
+}
+
+} // namespace
+
+// Explicit write transaction; rolled back unless committed
+class LCMManager::Transaction {
+public:
+    explicit Transaction(sqlite3* db) : db_(db), open_(false) {
+        begin();
+    }
+    
+    ~Transaction() {
+        if (open_) {
+            sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr);
+        }
+    }
+    
+    Transaction(const Transaction&) = delete;
+    Transaction& operator=(const Transaction&) = delete;
+    
+    void commit() {
+        exec("COMMIT");
+        open_ = false;
+    }
+    
+    // One write inside the transaction that can be undone on its own
+    void beginSavepoint() {
+        exec("SAVEPOINT lcm_write");
+    }
+    
+    void releaseSavepoint() {
+        exec("RELEASE lcm_write");
+    }
+    
+    // Undoes the write since beginSavepoint; returns false if the error
+    // already made SQLite roll back the whole transaction
+    bool rollbackToSavepoint() {
+        if (sqlite3_get_autocommit(db_)) {
+            open_ = false;
+            return false;
+        }
+        exec("ROLLBACK TO lcm_write");
+        exec("RELEASE lcm_write");
+        return true;
+    }
+
+private:
+    sqlite3* db_;
+    bool open_;
+    
+    void begin() {
+        exec("BEGIN IMMEDIATE");
+        open_ = true;
+    }
+    
+    void exec(const char* sql) {
+        char* errMsg = nullptr;
+        if (sqlite3_exec(db_, sql, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+            std::string error = errMsg ? errMsg : sqlite3_errmsg(db_);
+            sqlite3_free(errMsg);
+            throw std::runtime_error("LCM transaction failed (" + std::string(sql) + "): " + error);
+        }
+    }
+};
+
+// Read-only connections to the database file, opened on demand up to one
+// per hardware thread and kept for reuse. Under WAL each read runs on its own
+// snapshot, concurrently with other readers and with the writer. Databases
+// that aren't in WAL mode (in-memory, or filesystems without shared memory)
+// read through statements on the writer connection instead.
+class LCMManager::ReaderPool {
+public:
+    // Statements for the read-only queries, prepared on one connection
+    struct Connection {
+        sqlite3* db;
+        bool ownsDb;
+        std::uint64_t generation;
+        sqlite3_stmt* findFileByHash = nullptr;
+        sqlite3_stmt* findChunksByFingerprint = nullptr;
+        sqlite3_stmt* findChunksByHash = nullptr;
+        sqlite3_stmt* findSimilarBand = nullptr;
+        sqlite3_stmt* getFileTypeName = nullptr;
+        sqlite3_stmt* loadSchemaDefinition = nullptr;
+        
+        Connection(sqlite3* connection, bool owns, std::uint64_t gen)
+            : db(connection), ownsDb(owns), generation(gen) {
+            try {
+                findFileByHash = prepare(
+                    "SELECT file_id, content_hash, path_hash, size_bytes, file_type_id, "
+                    "schema_id, first_seen_at, last_seen_at, bundle_id FROM file_index WHERE content_hash = ?");
+                findChunksByFingerprint = prepare(
+                    "SELECT chunk_id, file_id, chunk_fingerprint FROM chunk_index "
+                    "WHERE chunk_fingerprint = ? ORDER BY seen_count DESC LIMIT ?");
+                findChunksByHash = prepare(
+                    "SELECT chunk_id, file_id, chunk_fingerprint FROM chunk_index "
+                    "WHERE chunk_hash = ? ORDER BY seen_count DESC LIMIT ?");
+                findSimilarBand = prepare(
+                    "SELECT s.chunk_id, s.simhash, c.file_id, c.chunk_fingerprint FROM chunk_similarity s "
+                    "JOIN chunk_index c ON c.chunk_id = s.chunk_id WHERE s.band_key = ? "
+                    "ORDER BY s.chunk_id DESC LIMIT ?");
+                getFileTypeName = prepare("SELECT name FROM file_types WHERE file_type_id = ?");
+                loadSchemaDefinition = prepare("SELECT definition FROM schema_registry WHERE schema_id = ?");
+            } catch (...) {
+                close();
+                throw;
+            }
+        }
+        
+        ~Connection() {
+            close();
+        }
+        
+        Connection(const Connection&) = delete;
+        Connection& operator=(const Connection&) = delete;
+    
+    private:
+        sqlite3_stmt* prepare(const char* sql) {
+            sqlite3_stmt* stmt = nullptr;
+            if (sqlite3_prepare_v3(db, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK) {
+                throw std::runtime_error("Failed to prepare LCM statement: " + std::string(sqlite3_errmsg(db)));
+            }
+            return stmt;
+        }
+        
+        void close() {
+            sqlite3_finalize(findFileByHash);
+            sqlite3_finalize(findChunksByFingerprint);
+            sqlite3_finalize(findChunksByHash);
+            sqlite3_finalize(findSimilarBand);
+            sqlite3_finalize(getFileTypeName);
+            sqlite3_finalize(loadSchemaDefinition);
+            if (ownsDb) {
+                sqlite3_close(db);
+            }
+        }
+    };
+    
+    ReaderPool(const std::filesystem::path& dbPath, sqlite3* writer, LCMDurability durability, bool pooled)
+        : dbPath_(dbPath)
+        , maxConnections_(std::clamp<std::size_t>(std::thread::hardware_concurrency(), 2, 16))
+        , durability_(durability)
+        , generation_(0)
+        , open_(0) {
+        if (!pooled) {
+            writerReads_ = std::make_unique<Connection>(writer, false, 0);
+        }
+    }
+    
+    bool isPooled() const {
+        return !writerReads_;
+    }
+    
+    // Only valid when !isPooled(); callers hold the writer mutex
+    Connection& writerReads() {
+        return *writerReads_;
+    }
+    
+    // An idle connection, a new one if under the limit, or else waits for a release
+    std::unique_ptr<Connection> acquire() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        available_.wait(lock, [this] { return !idle_.empty() || open_ < maxConnections_; });
+        if (!idle_.empty()) {
+            std::unique_ptr<Connection> connection = std::move(idle_.back());
+            idle_.pop_back();
+            return connection;
+        }
+        
+        ++open_;
+        const LCMDurability durability = durability_;
+        const std::uint64_t generation = generation_;
+        lock.unlock();
+        try {
+            return open(durability, generation);
+        } catch (...) {
+            lock.lock();
+            --open_;
+            available_.notify_one();
+            throw;
+        }
+    }
+    
+    // Connections opened before the last setDurability() are closed, not kept
+    void release(std::unique_ptr<Connection> connection) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (connection->generation == generation_) {
+                idle_.push_back(std::move(connection));
+            } else {
+                --open_;
+            }
+        }
+        available_.notify_one();
+    }
+    
+    void setDurability(LCMDurability durability) {
+        std::vector<std::unique_ptr<Connection>> stale;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            durability_ = durability;
+            ++generation_;
+            open_ -= idle_.size();
+            stale.swap(idle_);
+        }
+        available_.notify_all();
+    }
+
+private:
+    std::filesystem::path dbPath_;
+    std::size_t maxConnections_;
+    std::unique_ptr<Connection> writerReads_;
+    
+    std::mutex mutex_;
+    std::condition_variable available_;
+    std::vector<std::unique_ptr<Connection>> idle_;
+    LCMDurability durability_;
+    std::uint64_t generation_;
+    std::size_t open_;  // Idle plus leased
+    
+    std::unique_ptr<Connection> open(LCMDurability durability, std::uint64_t generation) const {
+        sqlite3* db = nullptr;
+        int rc = sqlite3_open_v2(dbPath_.string().c_str(), &db,
+                                 SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr);
+        if (rc != SQLITE_OK) {
+            std::string error = db ? sqlite3_errmsg(db) : "out of memory";
+            sqlite3_close(db);
+            throw std::runtime_error("Failed to open LCM reader: " + error);
+        }
+        
+        // Readers share the mapped file; each gets a quarter of the writer's page cache
+        const DurabilityPragmas pragmas = pragmasFor(durability);
+        sqlite3_busy_timeout(db, pragmas.busyTimeoutMs);
+        std::ostringstream oss;
+        oss << "PRAGMA mmap_size = " << pragmas.mmapSize << ";"
+            << "PRAGMA cache_size = " << -(pragmas.cacheSizeKiB / 4) << ";"
+            << "PRAGMA temp_store = " << pragmas.tempStore << ";";
+        sqlite3_exec(db, oss.str().c_str(), nullptr, nullptr, nullptr);
+        
+        return std::make_unique<Connection>(db, true, generation);
+    }
+};
+
+// The connection for one read-only call: leased from the pool, or the
+// writer's own, held under the writer mutex
+class LCMManager::ReadLease {
+public:
+    ReadLease(ReaderPool& pool, std::mutex& writerMutex) : pool_(pool) {
+        if (pool.isPooled()) {
+            leased_ = pool.acquire();
+            connection_ = leased_.get();
+        } else {
+            writerLock_ = std::unique_lock<std::mutex>(writerMutex);
+            connection_ = &pool.writerReads();
+        }
+    }
+    
+    ~ReadLease() {
+        if (leased_) {
+            pool_.release(std::move(leased_));
+        }
+    }
+    
+    ReadLease(const ReadLease&) = delete;
+    ReadLease& operator=(const ReadLease&) = delete;
+    
+    ReaderPool::Connection* operator->() const {
+        return connection_;
+    }
+
+private:
+    ReaderPool& pool_;
+    std::unique_ptr<ReaderPool::Connection> leased_;
+    std::unique_lock<std::mutex> writerLock_;
+    ReaderPool::Connection* connection_;
+};
+
+std::unique_ptr<LCMManager> LCMManager::createDefault(LCMDurability durability) {
     std::filesystem::path dbPath;
     
 #ifdef _WIN32
@@ -44,19 +533,22 @@ std::unique_ptr<LCMManager> LCMManager::createDefault() {
     // Create parent directories
     std::filesystem::create_directories(dbPath.parent_path());
     
-    return std::make_unique<LCMManager>(dbPath);
+    return std::make_unique<LCMManager>(dbPath, durability);
 }
 
-LCMManager::LCMManager(const std::filesystem::path& dbPath)
+LCMManager::LCMManager(const std::filesystem::path& dbPath, LCMDurability durability)
     : db_(nullptr)
     , dbPath_(dbPath)
     , stmtRegisterFile_(nullptr)
-    , stmtFindFileByHash_(nullptr)
-    , stmtRecordChunk_(nullptr)
-    , stmtFindChunksByFingerprint_(nullptr)
+    , stmtUpdateFileLastSeen_(nullptr)
+    , stmtInsertSimilarity_(nullptr)
     , stmtGetOrCreateFileType_(nullptr)
+    , stmtInsertFileType_(nullptr)
     , stmtGetOrCreateSchema_(nullptr)
-    , stmtIncrementSchemaUsage_(nullptr) {
+    , stmtInsertSchema_(nullptr)
+    , stmtIncrementSchemaUsage_(nullptr)
+    , chunkBatchSize_(DEFAULT_CHUNK_BATCH_SIZE)
+    , durability_(durability) {
     
     int rc = sqlite3_open(dbPath.string().c_str(), &db_);
     if (rc != SQLITE_OK) {
@@ -66,11 +558,26 @@ LCMManager::LCMManager(const std::filesystem::path& dbPath)
         throw std::runtime_error("Failed to open LCM database: " + error);
     }
     
-    initializeSchema();
-    prepareStatements();
+    try {
+        // Only takes effect on a new, empty database, so it must precede the
+        // WAL switch; older databases are converted by vacuum()
+        sqlite3_exec(db_, "PRAGMA auto_vacuum = INCREMENTAL", nullptr, nullptr, nullptr);
+        applyDurability(durability);
+        initializeSchema();
+        prepareStatements();
+        warmCaches();
+        readers_ = std::make_unique<ReaderPool>(dbPath_, db_, durability, isWalMode(db_));
+    } catch (...) {
+        readers_.reset();
+        finalizeStatements();
+        sqlite3_close(db_);
+        db_ = nullptr;
+        throw;
+    }
 }
 
 LCMManager::~LCMManager() {
+    readers_.reset();
     finalizeStatements();
     if (db_) {
         sqlite3_close(db_);
@@ -80,25 +587,20 @@ LCMManager::~LCMManager() {
 LCMManager::LCMManager(LCMManager&& other) noexcept
     : db_(other.db_)
     , dbPath_(std::move(other.dbPath_))
-    , stmtRegisterFile_(other.stmtRegisterFile_)
-    , stmtFindFileByHash_(other.stmtFindFileByHash_)
-    , stmtRecordChunk_(other.stmtRecordChunk_)
-    , stmtFindChunksByFingerprint_(other.stmtFindChunksByFingerprint_)
-    , stmtGetOrCreateFileType_(other.stmtGetOrCreateFileType_)
-    , stmtGetOrCreateSchema_(other.stmtGetOrCreateSchema_)
-    , stmtIncrementSchemaUsage_(other.stmtIncrementSchemaUsage_) {
+    , chunkBatchSize_(other.chunkBatchSize_)
+    , durability_(other.durability_)
+    , fileTypeIds_(std::move(other.fileTypeIds_))
+    , fileTypeNames_(std::move(other.fileTypeNames_))
+    , schemaIds_(std::move(other.schemaIds_))
+    , schemaDefinitions_(std::move(other.schemaDefinitions_))
+    , readers_(std::move(other.readers_)) {
     other.db_ = nullptr;
-    other.stmtRegisterFile_ = nullptr;
-    other.stmtFindFileByHash_ = nullptr;
-    other.stmtRecordChunk_ = nullptr;
-    other.stmtFindChunksByFingerprint_ = nullptr;
-    other.stmtGetOrCreateFileType_ = nullptr;
-    other.stmtGetOrCreateSchema_ = nullptr;
-    other.stmtIncrementSchemaUsage_ = nullptr;
+    takeStatements(other);
 }
 
 LCMManager& LCMManager::operator=(LCMManager&& other) noexcept {
     if (this != &other) {
+        readers_.reset();
         finalizeStatements();
         if (db_) {
             sqlite3_close(db_);
@@ -106,31 +608,152 @@ LCMManager& LCMManager::operator=(LCMManager&& other) noexcept {
         
         db_ = other.db_;
         dbPath_ = std::move(other.dbPath_);
-        stmtRegisterFile_ = other.stmtRegisterFile_;
-        stmtFindFileByHash_ = other.stmtFindFileByHash_;
-        stmtRecordChunk_ = other.stmtRecordChunk_;
-        stmtFindChunksByFingerprint_ = other.stmtFindChunksByFingerprint_;
-        stmtGetOrCreateFileType_ = other.stmtGetOrCreateFileType_;
-        stmtGetOrCreateSchema_ = other.stmtGetOrCreateSchema_;
-        stmtIncrementSchemaUsage_ = other.stmtIncrementSchemaUsage_;
-        
+        chunkBatchSize_ = other.chunkBatchSize_;
+        durability_ = other.durability_;
+        fileTypeIds_ = std::move(other.fileTypeIds_);
+        fileTypeNames_ = std::move(other.fileTypeNames_);
+        schemaIds_ = std::move(other.schemaIds_);
+        schemaDefinitions_ = std::move(other.schemaDefinitions_);
+        readers_ = std::move(other.readers_);
         other.db_ = nullptr;
-        other.stmtRegisterFile_ = nullptr;
-        other.stmtFindFileByHash_ = nullptr;
-        other.stmtRecordChunk_ = nullptr;
-        other.stmtFindChunksByFingerprint_ = nullptr;
-        other.stmtGetOrCreateFileType_ = nullptr;
-        other.stmtGetOrCreateSchema_ = nullptr;
-        other.stmtIncrementSchemaUsage_ = nullptr;
+        takeStatements(other);
     }
     return *this;
 }
 
+void LCMManager::takeStatements(LCMManager& other) {
+    stmtRegisterFile_ = std::exchange(other.stmtRegisterFile_, nullptr);
+    stmtUpdateFileLastSeen_ = std::exchange(other.stmtUpdateFileLastSeen_, nullptr);
+    stmtRecordChunkRows_ = std::exchange(other.stmtRecordChunkRows_, {});
+    stmtRecordOccurrenceRows_ = std::exchange(other.stmtRecordOccurrenceRows_, {});
+    stmtInsertSimilarity_ = std::exchange(other.stmtInsertSimilarity_, nullptr);
+    stmtGetOrCreateFileType_ = std::exchange(other.stmtGetOrCreateFileType_, nullptr);
+    stmtInsertFileType_ = std::exchange(other.stmtInsertFileType_, nullptr);
+    stmtGetOrCreateSchema_ = std::exchange(other.stmtGetOrCreateSchema_, nullptr);
+    stmtInsertSchema_ = std::exchange(other.stmtInsertSchema_, nullptr);
+    stmtIncrementSchemaUsage_ = std::exchange(other.stmtIncrementSchemaUsage_, nullptr);
+}
+
 void LCMManager::initializeSchema() {
     createTables();
+    migrateSchema();
     createIndices();
 }
 
+void LCMManager::migrateSchema() {
+    int version = 0;
+    {
+        sqlite3_stmt* stmt = prepare("SELECT schema_version FROM meta LIMIT 1");
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            version = sqlite3_column_int(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+    if (version >= LCM_SCHEMA_VERSION) {
+        return;
+    }
+    
+    Transaction txn(db_);
+    auto exec = [&](const char* sql) {
+        char* errMsg = nullptr;
+        if (sqlite3_exec(db_, sql, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+            std::string error = errMsg ? errMsg : "Unknown error";
+            sqlite3_free(errMsg);
+            throw std::runtime_error("Failed to migrate LCM schema from version " +
+                                     std::to_string(version) + ": " + error);
+        }
+    };
+    
+    // 2: hex TEXT hashes become BLOBs. The columns keep their declared TEXT
+    // type (SQLite stores BLOBs in them as-is); space is reclaimed by vacuum().
+    if (version < 2) {
+        sqlite3_create_function(db_, "rdx_hash_blob", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC,
+                                nullptr, hashBlobFunction, nullptr, nullptr);
+        exec("UPDATE file_index SET content_hash = rdx_hash_blob(content_hash), "
+             "path_hash = rdx_hash_blob(path_hash);"
+             "UPDATE chunk_index SET chunk_hash = rdx_hash_blob(chunk_hash);");
+        sqlite3_create_function(db_, "rdx_hash_blob", 1, SQLITE_UTF8, nullptr, nullptr, nullptr, nullptr);
+    }
+    
+    // 3: one chunk_index row per chunk_hash. Duplicates fold into the
+    // lowest chunk_id, their seen counts summed and their positions moved
+    // to chunk_occurrences.
+    if (version < 3) {
+        exec("CREATE TEMP TABLE chunk_keep (chunk_id INTEGER PRIMARY KEY, chunk_hash BLOB, seen INTEGER);"
+             "INSERT INTO chunk_keep SELECT MIN(chunk_id), chunk_hash, SUM(COALESCE(seen_count, 1)) "
+             "FROM chunk_index GROUP BY chunk_hash;"
+             "CREATE INDEX temp.idx_chunk_keep_hash ON chunk_keep(chunk_hash);"
+             "INSERT OR IGNORE INTO chunk_occurrences (file_id, offset_bytes, chunk_id) "
+             "SELECT c.file_id, c.offset_bytes, k.chunk_id FROM chunk_index c "
+             "JOIN chunk_keep k ON k.chunk_hash = c.chunk_hash;"
+             "DELETE FROM chunk_similarity WHERE chunk_id NOT IN (SELECT chunk_id FROM chunk_keep);"
+             "DELETE FROM chunk_index WHERE chunk_id NOT IN (SELECT chunk_id FROM chunk_keep);"
+             "UPDATE chunk_index SET seen_count = "
+             "(SELECT seen FROM chunk_keep k WHERE k.chunk_id = chunk_index.chunk_id);"
+             "DROP TABLE chunk_keep;"
+             "DROP INDEX IF EXISTS idx_chunk_hash;"
+             "CREATE UNIQUE INDEX IF NOT EXISTS idx_chunk_hash_unique ON chunk_index(chunk_hash);");
+    }
+    
+    // 4: file_type_stats, filled once from file_index; triggers maintain it
+    if (version < 4) {
+        exec("DELETE FROM file_type_stats;"
+             "INSERT INTO file_type_stats (file_type_id, file_count, total_bytes) "
+             "SELECT file_type_id, COUNT(*), COALESCE(SUM(size_bytes), 0) FROM file_index GROUP BY file_type_id;");
+    }
+    
+    std::ostringstream oss;
+    oss << "UPDATE meta SET schema_version = " << LCM_SCHEMA_VERSION
+        << ", last_updated_at = " << getCurrentTimestamp();
+    exec(oss.str().c_str());
+    txn.commit();
+}
+
+void LCMManager::setDurability(LCMDurability durability) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    applyDurability(durability);
+    durability_ = durability;
+    readers_->setDurability(durability);
+}
+
+LCMDurability LCMManager::getDurability() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return durability_;
+}
+
+LCMConnectionSettings LCMManager::getConnectionSettings(bool reader) const {
+    if (reader) {
+        ReadLease lease(*readers_, mutex_);
+        return readConnectionSettings(lease->db);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return readConnectionSettings(db_);
+}
+
+void LCMManager::applyDurability(LCMDurability durability) {
+    const DurabilityPragmas pragmas = pragmasFor(durability);
+    
+    // Set first so the pragmas below wait out other processes' locks
+    sqlite3_busy_timeout(db_, pragmas.busyTimeoutMs);
+    
+    // journal_mode reports the mode actually in effect; filesystems without
+    // shared memory (some network mounts) stay on the rollback journal
+    std::ostringstream oss;
+    oss << "PRAGMA journal_mode = WAL;"
+        << "PRAGMA synchronous = " << pragmas.synchronous << ";"
+        << "PRAGMA mmap_size = " << pragmas.mmapSize << ";"
+        << "PRAGMA cache_size = " << -pragmas.cacheSizeKiB << ";"
+        << "PRAGMA temp_store = " << pragmas.tempStore << ";";
+    
+    char* errMsg = nullptr;
+    int rc = sqlite3_exec(db_, oss.str().c_str(), nullptr, nullptr, &errMsg);
+    if (rc != SQLITE_OK) {
+        std::string error = errMsg ? errMsg : "Unknown error";
+        sqlite3_free(errMsg);
+        throw std::runtime_error("Failed to configure LCM database: " + error);
+    }
+}
+
 void LCMManager::createTables() {
     const char* sql = R"(
         CREATE TABLE IF NOT EXISTS meta (
@@ -143,8 +766,8 @@ void LCMManager::createTables() {
         
         CREATE TABLE IF NOT EXISTS file_index (
             file_id INTEGER PRIMARY KEY AUTOINCREMENT,
-            content_hash TEXT NOT NULL,
-            path_hash TEXT,
+            content_hash BLOB NOT NULL,
+            path_hash BLOB,
             size_bytes INTEGER NOT NULL,
             file_type_id INTEGER NOT NULL,
             schema_id INTEGER,
@@ -174,7 +797,7 @@ void LCMManager::createTables() {
             file_id INTEGER NOT NULL,
             offset_bytes INTEGER NOT NULL,
             length_bytes INTEGER NOT NULL,
-            chunk_hash TEXT NOT NULL,
+            chunk_hash BLOB NOT NULL,
             chunk_fingerprint INTEGER NOT NULL,
             schema_id INTEGER,
             token_profile_id INTEGER,
@@ -184,6 +807,25 @@ void LCMManager::createTables() {
             FOREIGN KEY (token_profile_id) REFERENCES token_profiles(token_profile_id)
         );
         
+        -- Where each distinct chunk occurs
+        CREATE TABLE IF NOT EXISTS chunk_occurrences (
+            file_id INTEGER NOT NULL,
+            offset_bytes INTEGER NOT NULL,
+            chunk_id INTEGER NOT NULL,
+            PRIMARY KEY (file_id, offset_bytes),
+            FOREIGN KEY (file_id) REFERENCES file_index(file_id),
+            FOREIGN KEY (chunk_id) REFERENCES chunk_index(chunk_id)
+        ) WITHOUT ROWID;
+        
+        -- LSH buckets of chunk SimHash signatures (one row per band)
+        CREATE TABLE IF NOT EXISTS chunk_similarity (
+            band_key INTEGER NOT NULL,
+            chunk_id INTEGER NOT NULL,
+            simhash INTEGER NOT NULL,
+            PRIMARY KEY (band_key, chunk_id),
+            FOREIGN KEY (chunk_id) REFERENCES chunk_index(chunk_id)
+        ) WITHOUT ROWID;
+        
         CREATE TABLE IF NOT EXISTS token_profiles (
             token_profile_id INTEGER PRIMARY KEY AUTOINCREMENT,
             file_type_id INTEGER NOT NULL,
@@ -232,6 +874,43 @@ void LCMManager::createTables() {
             avg_param_bits REAL,
             avg_residual_bits REAL
         );
+        
+        -- Per-type file counts and sizes, kept current by the triggers below
+        CREATE TABLE IF NOT EXISTS file_type_stats (
+            file_type_id INTEGER PRIMARY KEY,
+            file_count INTEGER NOT NULL DEFAULT 0,
+            total_bytes INTEGER NOT NULL DEFAULT 0
+        );
+        
+        CREATE TRIGGER IF NOT EXISTS trg_file_stats_insert AFTER INSERT ON file_index
+        BEGIN
+            INSERT INTO file_type_stats (file_type_id, file_count, total_bytes)
+            VALUES (NEW.file_type_id, 1, NEW.size_bytes)
+            ON CONFLICT(file_type_id) DO UPDATE SET
+                file_count = file_count + 1,
+                total_bytes = total_bytes + excluded.total_bytes;
+        END;
+        
+        CREATE TRIGGER IF NOT EXISTS trg_file_stats_delete AFTER DELETE ON file_index
+        BEGIN
+            UPDATE file_type_stats SET
+                file_count = file_count - 1,
+                total_bytes = total_bytes - OLD.size_bytes
+            WHERE file_type_id = OLD.file_type_id;
+        END;
+        
+        CREATE TRIGGER IF NOT EXISTS trg_file_stats_update AFTER UPDATE OF file_type_id, size_bytes ON file_index
+        BEGIN
+            UPDATE file_type_stats SET
+                file_count = file_count - 1,
+                total_bytes = total_bytes - OLD.size_bytes
+            WHERE file_type_id = OLD.file_type_id;
+            INSERT INTO file_type_stats (file_type_id, file_count, total_bytes)
+            VALUES (NEW.file_type_id, 1, NEW.size_bytes)
+            ON CONFLICT(file_type_id) DO UPDATE SET
+                file_count = file_count + 1,
+                total_bytes = total_bytes + excluded.total_bytes;
+        END;
     )";
     
     char* errMsg = nullptr;
@@ -250,8 +929,8 @@ void LCMManager::createTables() {
             sqlite3_finalize(stmt);
             std::int64_t now = getCurrentTimestamp();
             std::ostringstream oss;
-            oss << "INSERT INTO meta (schema_version, created_at, last_updated_at, codec_version) VALUES (1, " 
-                << now << ", " << now << ", '1.0.0')";
+            oss << "INSERT INTO meta (schema_version, created_at, last_updated_at, codec_version) VALUES ("
+                << LCM_SCHEMA_VERSION << ", " << now << ", " << now << ", '1.0.0')";
             sqlite3_exec(db_, oss.str().c_str(), nullptr, nullptr, nullptr);
         } else {
             sqlite3_finalize(stmt);
@@ -264,8 +943,11 @@ void LCMManager::createIndices() {
         CREATE INDEX IF NOT EXISTS idx_file_content_hash ON file_index(content_hash);
         CREATE INDEX IF NOT EXISTS idx_file_path_hash ON file_index(path_hash);
         CREATE INDEX IF NOT EXISTS idx_file_type ON file_index(file_type_id);
+        CREATE INDEX IF NOT EXISTS idx_file_last_seen ON file_index(last_seen_at);
         CREATE INDEX IF NOT EXISTS idx_chunk_file_id ON chunk_index(file_id);
-        CREATE INDEX IF NOT EXISTS idx_chunk_hash ON chunk_index(chunk_hash);
+        CREATE UNIQUE INDEX IF NOT EXISTS idx_chunk_hash_unique ON chunk_index(chunk_hash);
+        CREATE INDEX IF NOT EXISTS idx_occurrence_chunk ON chunk_occurrences(chunk_id);
+        CREATE INDEX IF NOT EXISTS idx_similarity_chunk ON chunk_similarity(chunk_id);
         CREATE INDEX IF NOT EXISTS idx_chunk_fingerprint ON chunk_index(chunk_fingerprint);
         CREATE INDEX IF NOT EXISTS idx_schema_usage ON schema_registry(usage_count);
     )";
@@ -273,34 +955,87 @@ void LCMManager::createIndices() {
     sqlite3_exec(db_, sql, nullptr, nullptr, nullptr);
 }
 
+sqlite3_stmt* LCMManager::prepare(const char* sql) const {
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v3(db_, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK) {
+        throw std::runtime_error("Failed to prepare LCM statement: " + std::string(sqlite3_errmsg(db_)));
+    }
+    return stmt;
+}
+
 void LCMManager::prepareStatements() {
-    // In production, properly prepare and cache statements
-    // For now, we'll use direct execution for simplicity
+    stmtRegisterFile_ = prepare(
+        "INSERT INTO file_index (content_hash, path_hash, size_bytes, file_type_id, schema_id, "
+        "first_seen_at, last_seen_at, bundle_id) VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+    stmtUpdateFileLastSeen_ = prepare("UPDATE file_index SET last_seen_at = ? WHERE file_id = ?");
+    stmtRecordChunkRows_.assign(CHUNK_INSERT_ROWS + 1, nullptr);
+    stmtRecordOccurrenceRows_.assign(CHUNK_INSERT_ROWS + 1, nullptr);
+    stmtRecordChunkRows_[CHUNK_INSERT_ROWS] = prepare(chunkInsertSql(CHUNK_INSERT_ROWS).c_str());
+    stmtRecordOccurrenceRows_[CHUNK_INSERT_ROWS] = prepare(occurrenceInsertSql(CHUNK_INSERT_ROWS).c_str());
+    stmtInsertSimilarity_ = prepare(
+        "INSERT OR IGNORE INTO chunk_similarity (band_key, chunk_id, simhash) "
+        "VALUES (?, ?, ?), (?, ?, ?), (?, ?, ?), (?, ?, ?)");
+    stmtGetOrCreateFileType_ = prepare("SELECT file_type_id FROM file_types WHERE name = ?");
+    stmtInsertFileType_ = prepare("INSERT INTO file_types (name, detector_signature) VALUES (?, ?)");
+    stmtGetOrCreateSchema_ = prepare("SELECT schema_id FROM schema_registry WHERE name = ? AND version = ?");
+    stmtInsertSchema_ = prepare(
+        "INSERT INTO schema_registry (name, version, definition, created_at, updated_at) "
+        "VALUES (?, ?, ?, ?, ?)");
+    stmtIncrementSchemaUsage_ = prepare(
+        "UPDATE schema_registry SET usage_count = usage_count + ? WHERE schema_id = ?");
 }
 
 void LCMManager::finalizeStatements() {
-    if (stmtRegisterFile_) sqlite3_finalize(stmtRegisterFile_);
-    if (stmtFindFileByHash_) sqlite3_finalize(stmtFindFileByHash_);
-    if (stmtRecordChunk_) sqlite3_finalize(stmtRecordChunk_);
-    if (stmtFindChunksByFingerprint_) sqlite3_finalize(stmtFindChunksByFingerprint_);
-    if (stmtGetOrCreateFileType_) sqlite3_finalize(stmtGetOrCreateFileType_);
-    if (stmtGetOrCreateSchema_) sqlite3_finalize(stmtGetOrCreateSchema_);
-    if (stmtIncrementSchemaUsage_) sqlite3_finalize(stmtIncrementSchemaUsage_);
+    // sqlite3_finalize accepts null
+    sqlite3_finalize(stmtRegisterFile_);
+    sqlite3_finalize(stmtUpdateFileLastSeen_);
+    for (sqlite3_stmt* stmt : stmtRecordChunkRows_) {
+        sqlite3_finalize(stmt);
+    }
+    for (sqlite3_stmt* stmt : stmtRecordOccurrenceRows_) {
+        sqlite3_finalize(stmt);
+    }
+    sqlite3_finalize(stmtInsertSimilarity_);
+    sqlite3_finalize(stmtGetOrCreateFileType_);
+    sqlite3_finalize(stmtInsertFileType_);
+    sqlite3_finalize(stmtGetOrCreateSchema_);
+    sqlite3_finalize(stmtInsertSchema_);
+    sqlite3_finalize(stmtIncrementSchemaUsage_);
+    stmtRegisterFile_ = nullptr;
+    stmtUpdateFileLastSeen_ = nullptr;
+    stmtRecordChunkRows_.clear();
+    stmtRecordOccurrenceRows_.clear();
+    stmtInsertSimilarity_ = nullptr;
+    stmtGetOrCreateFileType_ = nullptr;
+    stmtInsertFileType_ = nullptr;
+    stmtGetOrCreateSchema_ = nullptr;
+    stmtInsertSchema_ = nullptr;
+    stmtIncrementSchemaUsage_ = nullptr;
 }
 
 int LCMManager::registerFile(const FileInfo& info) {
-    std::ostringstream oss;
-    oss << "INSERT INTO file_index (content_hash, path_hash, size_bytes, file_type_id, schema_id, "
-        << "first_seen_at, last_seen_at, bundle_id) VALUES (?, ?, ?, ?, ?, ?, ?, ?)";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, oss.str().c_str(), -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
-        throw std::runtime_error("Failed to prepare register file statement");
+    std::lock_guard<std::mutex> lock(mutex_);
+    return insertFile(info);
+}
+
+int LCMManager::registerFileWithChunks(const FileInfo& info, std::vector<FileChunkInfo> chunks) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Transaction txn(db_);
+    int fileId = insertFile(info);
+    for (auto& chunk : chunks) {
+        chunk.fileId = fileId;
     }
+    insertChunks(chunks);
+    txn.commit();
+    return fileId;
+}
+
+int LCMManager::insertFile(const FileInfo& info) {
+    StatementScope scope(stmtRegisterFile_);
+    sqlite3_stmt* stmt = scope.get();
     
-    sqlite3_bind_text(stmt, 1, info.contentHash.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, info.pathHash.c_str(), -1, SQLITE_STATIC);
+    bindHash(stmt, 1, info.contentHash);
+    bindHash(stmt, 2, info.pathHash);
     sqlite3_bind_int64(stmt, 3, info.sizeBytes);
     sqlite3_bind_int(stmt, 4, info.fileTypeId);
     sqlite3_bind_int(stmt, 5, info.schemaId);
@@ -312,38 +1047,25 @@ int LCMManager::registerFile(const FileInfo& info) {
         sqlite3_bind_null(stmt, 8);
     }
     
-    rc = sqlite3_step(stmt);
-    int fileId = -1;
-    if (rc == SQLITE_DONE) {
-        fileId = static_cast<int>(sqlite3_last_insert_rowid(db_));
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        throw std::runtime_error("Failed to register file: " + std::string(sqlite3_errmsg(db_)));
     }
     
-    sqlite3_finalize(stmt);
-    
-    if (rc != SQLITE_DONE) {
-        throw std::runtime_error("Failed to register file");
-    }
-    
-    return fileId;
+    return static_cast<int>(sqlite3_last_insert_rowid(db_));
 }
 
 std::optional<FileInfo> LCMManager::findFileByContentHash(const std::string& contentHash) const {
-    const char* sql = "SELECT file_id, content_hash, path_hash, size_bytes, file_type_id, "
-                      "schema_id, first_seen_at, last_seen_at, bundle_id FROM file_index WHERE content_hash = ?";
+    ReadLease reader(*readers_, mutex_);
+    StatementScope scope(reader->findFileByHash);
+    sqlite3_stmt* stmt = scope.get();
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
-        return std::nullopt;
-    }
-    
-    sqlite3_bind_text(stmt, 1, contentHash.c_str(), -1, SQLITE_STATIC);
+    bindHash(stmt, 1, contentHash);
     
     std::optional<FileInfo> result;
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         FileInfo info;
-        info.contentHash = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        info.pathHash = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+        info.contentHash = readHash(stmt, 1);
+        info.pathHash = readHash(stmt, 2);
         info.sizeBytes = sqlite3_column_int64(stmt, 3);
         info.fileTypeId = sqlite3_column_int(stmt, 4);
         info.schemaId = sqlite3_column_int(stmt, 5);
@@ -355,65 +1077,166 @@ std::optional<FileInfo> LCMManager::findFileByContentHash(const std::string& con
         result = info;
     }
     
-    sqlite3_finalize(stmt);
     return result;
 }
 
 void LCMManager::updateFileLastSeen(int fileId, std::int64_t timestamp) {
-    std::ostringstream oss;
-    oss << "UPDATE file_index SET last_seen_at = ? WHERE file_id = ?";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, oss.str().c_str(), -1, &stmt, nullptr);
-    if (rc == SQLITE_OK) {
-        sqlite3_bind_int64(stmt, 1, timestamp);
-        sqlite3_bind_int(stmt, 2, fileId);
-        sqlite3_step(stmt);
-        sqlite3_finalize(stmt);
-    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    StatementScope scope(stmtUpdateFileLastSeen_);
+    sqlite3_bind_int64(scope.get(), 1, timestamp);
+    sqlite3_bind_int(scope.get(), 2, fileId);
+    sqlite3_step(scope.get());
 }
 
 void LCMManager::recordChunks(const std::vector<FileChunkInfo>& chunks) {
-    const char* sql = "INSERT INTO chunk_index (file_id, offset_bytes, length_bytes, chunk_hash, "
-                      "chunk_fingerprint, schema_id, token_profile_id, seen_count) "
-                      "VALUES (?, ?, ?, ?, ?, ?, ?, ?)";
-    
-    for (const auto& chunk : chunks) {
-        sqlite3_stmt* stmt;
-        int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-        if (rc == SQLITE_OK) {
-            sqlite3_bind_int(stmt, 1, chunk.fileId);
-            sqlite3_bind_int64(stmt, 2, chunk.offsetBytes);
-            sqlite3_bind_int64(stmt, 3, chunk.lengthBytes);
-            sqlite3_bind_text(stmt, 4, chunk.chunkHash.c_str(), -1, SQLITE_STATIC);
-            sqlite3_bind_int64(stmt, 5, static_cast<std::int64_t>(chunk.chunkFingerprint));
-            sqlite3_bind_int(stmt, 6, chunk.schemaId);
-            if (chunk.tokenProfileId.has_value()) {
-                sqlite3_bind_int(stmt, 7, chunk.tokenProfileId.value());
-            } else {
-                sqlite3_bind_null(stmt, 7);
-            }
-            sqlite3_bind_int64(stmt, 8, chunk.seenCount);
-            
-            sqlite3_step(stmt);
-            sqlite3_finalize(stmt);
-        }
+    if (chunks.empty()) {
+        return;
     }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    Transaction txn(db_);
+    insertChunks(chunks);
+    txn.commit();
 }
 
-std::vector<ChunkMatch> LCMManager::findSimilarChunks(std::uint64_t fingerprint, std::size_t limit) const {
-    const char* sql = "SELECT chunk_id, file_id, chunk_fingerprint FROM chunk_index "
-                      "WHERE chunk_fingerprint = ? ORDER BY seen_count DESC LIMIT ?";
+std::vector<LCMWriteFailure> LCMManager::applyWrites(std::span<LCMWrite> writes) {
+    std::vector<LCMWriteFailure> failures;
+    if (writes.empty()) {
+        return failures;
+    }
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
-        return {};
+    std::lock_guard<std::mutex> lock(mutex_);
+    Transaction txn(db_);
+    std::map<int, int> usageBySchema;
+    
+    for (std::size_t i = 0; i < writes.size(); ++i) {
+        LCMWrite& write = writes[i];
+        switch (write.kind) {
+            case LCMWrite::Kind::RegisterFile: {
+                // A file that fails is undone alone; the rest of the batch stands
+                txn.beginSavepoint();
+                try {
+                    int fileId = insertFile(write.file);
+                    for (auto& chunk : write.chunks) {
+                        chunk.fileId = fileId;
+                    }
+                    insertChunks(write.chunks);
+                    txn.releaseSavepoint();
+                } catch (const std::exception& e) {
+                    if (!txn.rollbackToSavepoint()) {
+                        throw;
+                    }
+                    failures.push_back({i, e.what()});
+                    break;
+                }
+                if (write.countsSchemaUse) {
+                    ++usageBySchema[write.file.schemaId];
+                }
+                break;
+            }
+            case LCMWrite::Kind::IncrementSchemaUsage:
+                ++usageBySchema[write.schemaId];
+                break;
+        }
     }
     
-    sqlite3_bind_int64(stmt, 1, static_cast<std::int64_t>(fingerprint));
-    sqlite3_bind_int64(stmt, 2, static_cast<std::int64_t>(limit));
+    for (const auto& [schemaId, count] : usageBySchema) {
+        StatementScope scope(stmtIncrementSchemaUsage_);
+        sqlite3_bind_int(scope.get(), 1, count);
+        sqlite3_bind_int(scope.get(), 2, schemaId);
+        if (sqlite3_step(scope.get()) != SQLITE_DONE) {
+            throw std::runtime_error("Failed to update schema usage: " + std::string(sqlite3_errmsg(db_)));
+        }
+    }
     
+    txn.commit();
+    return failures;
+}
+
+sqlite3_stmt* LCMManager::chunkInsertStatement(std::size_t rows) {
+    sqlite3_stmt*& stmt = stmtRecordChunkRows_[rows];
+    if (!stmt) {
+        stmt = prepare(chunkInsertSql(rows).c_str());
+    }
+    return stmt;
+}
+
+sqlite3_stmt* LCMManager::occurrenceInsertStatement(std::size_t rows) {
+    sqlite3_stmt*& stmt = stmtRecordOccurrenceRows_[rows];
+    if (!stmt) {
+        stmt = prepare(occurrenceInsertSql(rows).c_str());
+    }
+    return stmt;
+}
+
+void LCMManager::insertChunks(std::span<const FileChunkInfo> chunks) {
+    std::size_t index = 0;
+    while (index < chunks.size()) {
+        // Full multi-row statements, then one statement for the tail
+        std::size_t rows = std::min(chunks.size() - index, CHUNK_INSERT_ROWS);
+        
+        // Per chunk_hash in this statement: id, seen_count afterwards (the
+        // largest returned) and the count this statement added. They are
+        // equal when the chunk is new.
+        struct Upserted {
+            std::int64_t chunkId = 0;
+            std::int64_t seenCount = 0;
+            std::int64_t added = 0;
+        };
+        std::unordered_map<std::string, Upserted> upserted;
+        {
+            StatementScope scope(chunkInsertStatement(rows));
+            for (std::size_t i = 0; i < rows; ++i) {
+                bindChunk(scope.get(), static_cast<int>(i) * CHUNK_COLUMNS + 1, chunks[index + i]);
+                upserted[chunks[index + i].chunkHash].added += chunks[index + i].seenCount;
+            }
+            int rc;
+            while ((rc = sqlite3_step(scope.get())) == SQLITE_ROW) {
+                Upserted& row = upserted[readHash(scope.get(), 1)];
+                row.chunkId = sqlite3_column_int64(scope.get(), 0);
+                row.seenCount = std::max<std::int64_t>(row.seenCount, sqlite3_column_int64(scope.get(), 2));
+            }
+            if (rc != SQLITE_DONE) {
+                throw std::runtime_error("Failed to record chunks: " + std::string(sqlite3_errmsg(db_)));
+            }
+        }
+        
+        StatementScope occurrences(occurrenceInsertStatement(rows));
+        for (std::size_t i = 0; i < rows; ++i) {
+            const auto& chunk = chunks[index + i];
+            Upserted& row = upserted.at(chunk.chunkHash);
+            int param = static_cast<int>(i) * 3 + 1;
+            sqlite3_bind_int(occurrences.get(), param, chunk.fileId);
+            sqlite3_bind_int64(occurrences.get(), param + 1, chunk.offsetBytes);
+            sqlite3_bind_int64(occurrences.get(), param + 2, row.chunkId);
+            
+            // Only new chunks need a signature; a repeat finds the one indexed before
+            if (chunk.simHash.has_value() && row.seenCount == row.added) {
+                insertSimilarity(row.chunkId, chunk.simHash.value());
+                row.added = -1;  // Indexed; skip later rows of the same chunk
+            }
+        }
+        if (sqlite3_step(occurrences.get()) != SQLITE_DONE) {
+            throw std::runtime_error("Failed to record chunk occurrences: " + std::string(sqlite3_errmsg(db_)));
+        }
+        
+        index += rows;
+    }
+}
+
+void LCMManager::setChunkBatchSize(std::size_t rowsPerTransaction) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    chunkBatchSize_ = std::max<std::size_t>(rowsPerTransaction, 1);
+}
+
+std::size_t LCMManager::getChunkBatchSize() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return chunkBatchSize_;
+}
+
+namespace {
+
+std::vector<ChunkMatch> readChunkMatches(sqlite3_stmt* stmt) {
     std::vector<ChunkMatch> results;
     while (sqlite3_step(stmt) == SQLITE_ROW) {
         ChunkMatch match;
@@ -423,167 +1246,262 @@ std::vector<ChunkMatch> LCMManager::findSimilarChunks(std::uint64_t fingerprint,
         match.similarity = 1.0; // Exact match
         results.push_back(match);
     }
-    
-    sqlite3_finalize(stmt);
     return results;
 }
 
-std::vector<ChunkMatch> LCMManager::findSimilarChunksByHash(const std::string& chunkHash, std::size_t limit) const {
-    const char* sql = "SELECT chunk_id, file_id, chunk_fingerprint FROM chunk_index "
-                      "WHERE chunk_hash = ? ORDER BY seen_count DESC LIMIT ?";
+} // namespace
+
+std::vector<ChunkMatch> LCMManager::findSimilarChunks(std::uint64_t fingerprint, std::size_t limit) const {
+    ReadLease reader(*readers_, mutex_);
+    StatementScope scope(reader->findChunksByFingerprint);
+    sqlite3_bind_int64(scope.get(), 1, static_cast<std::int64_t>(fingerprint));
+    sqlite3_bind_int64(scope.get(), 2, static_cast<std::int64_t>(limit));
+    return readChunkMatches(scope.get());
+}
+
+std::vector<ChunkMatch> LCMManager::findSimilarChunks(std::uint64_t signature, int maxDistance,
+                                                      std::size_t limit) const {
+    ReadLease reader(*readers_, mutex_);
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
-        return {};
+    std::unordered_map<int, ChunkMatch> candidates;
+    for (int band = 0; band < LSH_BANDS; ++band) {
+        StatementScope scope(reader->findSimilarBand);
+        sqlite3_bind_int64(scope.get(), 1, lshBandKey(signature, band));
+        sqlite3_bind_int64(scope.get(), 2, static_cast<std::int64_t>(LSH_BUCKET_SCAN_LIMIT));
+        while (sqlite3_step(scope.get()) == SQLITE_ROW) {
+            int chunkId = sqlite3_column_int(scope.get(), 0);
+            auto simHash = static_cast<std::uint64_t>(sqlite3_column_int64(scope.get(), 1));
+            int distance = std::popcount(simHash ^ signature);
+            if (distance > maxDistance || candidates.count(chunkId)) {
+                continue;
+            }
+            
+            ChunkMatch match;
+            match.chunkId = chunkId;
+            match.fileId = sqlite3_column_int(scope.get(), 2);
+            match.fingerprint = static_cast<std::uint64_t>(sqlite3_column_int64(scope.get(), 3));
+            match.similarity = 1.0 - static_cast<double>(distance) / 64.0;
+            candidates.emplace(chunkId, match);
+        }
     }
     
-    sqlite3_bind_text(stmt, 1, chunkHash.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int64(stmt, 2, static_cast<std::int64_t>(limit));
-    
     std::vector<ChunkMatch> results;
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        ChunkMatch match;
-        match.chunkId = sqlite3_column_int(stmt, 0);
-        match.fileId = sqlite3_column_int(stmt, 1);
-        match.fingerprint = static_cast<std::uint64_t>(sqlite3_column_int64(stmt, 2));
-        match.similarity = 1.0;
+    results.reserve(candidates.size());
+    for (auto& [chunkId, match] : candidates) {
         results.push_back(match);
     }
+    std::sort(results.begin(), results.end(), [](const ChunkMatch& a, const ChunkMatch& b) {
+        return a.similarity != b.similarity ? a.similarity > b.similarity : a.chunkId < b.chunkId;
+    });
+    if (results.size() > limit) {
+        results.resize(limit);
+    }
+    return results;
+}
+
+void LCMManager::insertSimilarity(std::int64_t chunkId, std::uint64_t simHash) {
+    StatementScope scope(stmtInsertSimilarity_);
+    for (int band = 0; band < LSH_BANDS; ++band) {
+        sqlite3_bind_int64(scope.get(), band * 3 + 1, lshBandKey(simHash, band));
+        sqlite3_bind_int64(scope.get(), band * 3 + 2, chunkId);
+        sqlite3_bind_int64(scope.get(), band * 3 + 3, static_cast<std::int64_t>(simHash));
+    }
+    if (sqlite3_step(scope.get()) != SQLITE_DONE) {
+        throw std::runtime_error("Failed to index chunk similarity: " + std::string(sqlite3_errmsg(db_)));
+    }
+}
+
+std::vector<ChunkMatch> LCMManager::findSimilarChunksByHash(const std::string& chunkHash, std::size_t limit) const {
+    ReadLease reader(*readers_, mutex_);
+    StatementScope scope(reader->findChunksByHash);
+    bindHash(scope.get(), 1, chunkHash);
+    sqlite3_bind_int64(scope.get(), 2, static_cast<std::int64_t>(limit));
+    return readChunkMatches(scope.get());
+}
+
+void LCMManager::warmCaches() {
+    std::unique_lock<std::shared_mutex> cacheLock(cacheMutex_);
     
+    sqlite3_stmt* stmt = prepare("SELECT file_type_id, name FROM file_types");
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int id = sqlite3_column_int(stmt, 0);
+        std::string name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        fileTypeIds_[name] = id;
+        fileTypeNames_[id] = std::move(name);
+    }
+    sqlite3_finalize(stmt);
+    
+    stmt = prepare("SELECT schema_id, name, version, definition FROM schema_registry");
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int id = sqlite3_column_int(stmt, 0);
+        std::string name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        schemaIds_[{std::move(name), sqlite3_column_int(stmt, 2)}] = id;
+        schemaDefinitions_[id] = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+    }
     sqlite3_finalize(stmt);
-    return results;
 }
 
 int LCMManager::getOrCreateFileTypeId(const std::string& name, const std::string& detectorSignature) {
-    // Try to find existing
-    const char* sql = "SELECT file_type_id FROM file_types WHERE name = ?";
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc == SQLITE_OK) {
-        sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_STATIC);
-        if (sqlite3_step(stmt) == SQLITE_ROW) {
-            int id = sqlite3_column_int(stmt, 0);
-            sqlite3_finalize(stmt);
-            return id;
+    {
+        std::shared_lock<std::shared_mutex> cacheLock(cacheMutex_);
+        auto it = fileTypeIds_.find(name);
+        if (it != fileTypeIds_.end()) {
+            return it->second;
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    int id = -1;
+    
+    // Try to find existing (another thread or process may have added it)
+    {
+        StatementScope scope(stmtGetOrCreateFileType_);
+        sqlite3_bind_text(scope.get(), 1, name.c_str(), -1, SQLITE_STATIC);
+        if (sqlite3_step(scope.get()) == SQLITE_ROW) {
+            id = sqlite3_column_int(scope.get(), 0);
         }
-        sqlite3_finalize(stmt);
     }
     
     // Create new
-    sql = "INSERT INTO file_types (name, detector_signature) VALUES (?, ?)";
-    rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc == SQLITE_OK) {
-        sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 2, detectorSignature.c_str(), -1, SQLITE_STATIC);
-        sqlite3_step(stmt);
-        int id = static_cast<int>(sqlite3_last_insert_rowid(db_));
-        sqlite3_finalize(stmt);
-        return id;
+    if (id < 0) {
+        StatementScope scope(stmtInsertFileType_);
+        sqlite3_bind_text(scope.get(), 1, name.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(scope.get(), 2, detectorSignature.c_str(), -1, SQLITE_STATIC);
+        if (sqlite3_step(scope.get()) != SQLITE_DONE) {
+            return -1;
+        }
+        id = static_cast<int>(sqlite3_last_insert_rowid(db_));
     }
     
-    return -1;
+    std::unique_lock<std::shared_mutex> cacheLock(cacheMutex_);
+    fileTypeIds_[name] = id;
+    fileTypeNames_[id] = name;
+    return id;
 }
 
 std::string LCMManager::getFileTypeName(int fileTypeId) const {
-    const char* sql = "SELECT name FROM file_types WHERE file_type_id = ?";
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc == SQLITE_OK) {
-        sqlite3_bind_int(stmt, 1, fileTypeId);
-        if (sqlite3_step(stmt) == SQLITE_ROW) {
-            std::string name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-            sqlite3_finalize(stmt);
-            return name;
+    {
+        std::shared_lock<std::shared_mutex> cacheLock(cacheMutex_);
+        auto it = fileTypeNames_.find(fileTypeId);
+        if (it != fileTypeNames_.end()) {
+            return it->second;
         }
-        sqlite3_finalize(stmt);
     }
-    return "";
+    
+    ReadLease reader(*readers_, mutex_);
+    StatementScope scope(reader->getFileTypeName);
+    sqlite3_bind_int(scope.get(), 1, fileTypeId);
+    if (sqlite3_step(scope.get()) != SQLITE_ROW) {
+        return "";
+    }
+    
+    std::string name = reinterpret_cast<const char*>(sqlite3_column_text(scope.get(), 0));
+    std::unique_lock<std::shared_mutex> cacheLock(cacheMutex_);
+    fileTypeIds_[name] = fileTypeId;
+    fileTypeNames_[fileTypeId] = name;
+    return name;
 }
 
 int LCMManager::getOrCreateSchemaId(const std::string& name, int version, const std::string& definition) {
-    // Try to find existing
-    const char* sql = "SELECT schema_id FROM schema_registry WHERE name = ? AND version = ?";
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc == SQLITE_OK) {
-        sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_int(stmt, 2, version);
-        if (sqlite3_step(stmt) == SQLITE_ROW) {
-            int id = sqlite3_column_int(stmt, 0);
-            sqlite3_finalize(stmt);
+    {
+        std::shared_lock<std::shared_mutex> cacheLock(cacheMutex_);
+        auto it = schemaIds_.find({name, version});
+        if (it != schemaIds_.end()) {
+            return it->second;
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    // Try to find existing (another thread or process may have added it)
+    {
+        StatementScope scope(stmtGetOrCreateSchema_);
+        sqlite3_bind_text(scope.get(), 1, name.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int(scope.get(), 2, version);
+        if (sqlite3_step(scope.get()) == SQLITE_ROW) {
+            int id = sqlite3_column_int(scope.get(), 0);
+            std::unique_lock<std::shared_mutex> cacheLock(cacheMutex_);
+            schemaIds_[{name, version}] = id;
             return id;
         }
-        sqlite3_finalize(stmt);
     }
     
     // Create new
     std::int64_t now = getCurrentTimestamp();
-    std::ostringstream oss;
-    oss << "INSERT INTO schema_registry (name, version, definition, created_at, updated_at) "
-        << "VALUES (?, ?, ?, " << now << ", " << now << ")";
-    rc = sqlite3_prepare_v2(db_, oss.str().c_str(), -1, &stmt, nullptr);
-    if (rc == SQLITE_OK) {
-        sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_int(stmt, 2, version);
-        sqlite3_bind_text(stmt, 3, definition.c_str(), -1, SQLITE_STATIC);
-        sqlite3_step(stmt);
-        int id = static_cast<int>(sqlite3_last_insert_rowid(db_));
-        sqlite3_finalize(stmt);
-        return id;
+    StatementScope scope(stmtInsertSchema_);
+    sqlite3_bind_text(scope.get(), 1, name.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(scope.get(), 2, version);
+    sqlite3_bind_text(scope.get(), 3, definition.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(scope.get(), 4, now);
+    sqlite3_bind_int64(scope.get(), 5, now);
+    if (sqlite3_step(scope.get()) != SQLITE_DONE) {
+        return -1;
     }
+    int id = static_cast<int>(sqlite3_last_insert_rowid(db_));
     
-    return -1;
+    std::unique_lock<std::shared_mutex> cacheLock(cacheMutex_);
+    schemaIds_[{name, version}] = id;
+    schemaDefinitions_[id] = definition;
+    return id;
 }
 
 std::optional<std::string> LCMManager::loadSchemaDefinition(int schemaId) const {
-    const char* sql = "SELECT definition FROM schema_registry WHERE schema_id = ?";
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc == SQLITE_OK) {
-        sqlite3_bind_int(stmt, 1, schemaId);
-        if (sqlite3_step(stmt) == SQLITE_ROW) {
-            std::string def = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-            sqlite3_finalize(stmt);
-            return def;
+    {
+        std::shared_lock<std::shared_mutex> cacheLock(cacheMutex_);
+        auto it = schemaDefinitions_.find(schemaId);
+        if (it != schemaDefinitions_.end()) {
+            return it->second;
         }
-        sqlite3_finalize(stmt);
     }
-    return std::nullopt;
+    
+    ReadLease reader(*readers_, mutex_);
+    StatementScope scope(reader->loadSchemaDefinition);
+    sqlite3_bind_int(scope.get(), 1, schemaId);
+    if (sqlite3_step(scope.get()) != SQLITE_ROW) {
+        return std::nullopt;
+    }
+    
+    std::string definition = reinterpret_cast<const char*>(sqlite3_column_text(scope.get(), 0));
+    std::unique_lock<std::shared_mutex> cacheLock(cacheMutex_);
+    schemaDefinitions_[schemaId] = definition;
+    return definition;
 }
 
 void LCMManager::incrementSchemaUsage(int schemaId) {
-    const char* sql = "UPDATE schema_registry SET usage_count = usage_count + 1 WHERE schema_id = ?";
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc == SQLITE_OK) {
-        sqlite3_bind_int(stmt, 1, schemaId);
-        sqlite3_step(stmt);
-        sqlite3_finalize(stmt);
-    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    StatementScope scope(stmtIncrementSchemaUsage_);
+    sqlite3_bind_int(scope.get(), 1, 1);
+    sqlite3_bind_int(scope.get(), 2, schemaId);
+    sqlite3_step(scope.get());
 }
 
 void LCMManager::updateSchemaStats(int schemaId, const std::vector<FieldStatUpdate>& updates) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    // Infrequent: prepared per call, but only once for all updates
+    const char* sql = "INSERT OR REPLACE INTO schema_stats (schema_id, field_name, field_kind, stats_blob) "
+                      "VALUES (?, ?, ?, ?)";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return;
+    }
+    
     for (const auto& update : updates) {
-        const char* sql = "INSERT OR REPLACE INTO schema_stats (schema_id, field_name, field_kind, stats_blob) "
-                          "VALUES (?, ?, ?, ?)";
-        sqlite3_stmt* stmt;
-        int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-        if (rc == SQLITE_OK) {
-            sqlite3_bind_int(stmt, 1, schemaId);
-            sqlite3_bind_text(stmt, 2, update.fieldName.c_str(), -1, SQLITE_STATIC);
-            sqlite3_bind_text(stmt, 3, update.fieldKind.c_str(), -1, SQLITE_STATIC);
-            sqlite3_bind_text(stmt, 4, update.statsBlob.c_str(), -1, SQLITE_STATIC);
-            sqlite3_step(stmt);
-            sqlite3_finalize(stmt);
-        }
+        sqlite3_bind_int(stmt, 1, schemaId);
+        sqlite3_bind_text(stmt, 2, update.fieldName.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 3, update.fieldKind.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 4, update.statsBlob.c_str(), -1, SQLITE_STATIC);
+        sqlite3_step(stmt);
+        sqlite3_reset(stmt);
     }
+    sqlite3_finalize(stmt);
 }
 
 std::vector<std::pair<int, int>> LCMManager::getTopSchemasByUsage(std::size_t limit) const {
+    ReadLease reader(*readers_, mutex_);
     const char* sql = "SELECT schema_id, usage_count FROM schema_registry ORDER BY usage_count DESC LIMIT ?";
     sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
+    int rc = sqlite3_prepare_v2(reader->db, sql, -1, &stmt, nullptr);
     if (rc != SQLITE_OK) {
         return {};
     }
@@ -600,6 +1518,7 @@ std::vector<std::pair<int, int>> LCMManager::getTopSchemasByUsage(std::size_t li
 }
 
 int LCMManager::createBundle(const std::string& bundleHash, const std::string& label) {
+    std::lock_guard<std::mutex> lock(mutex_);
     std::int64_t now = getCurrentTimestamp();
     std::ostringstream oss;
     oss << "INSERT INTO bundles (bundle_hash, label, created_at) VALUES (?, ?, " << now << ")";
@@ -618,6 +1537,7 @@ int LCMManager::createBundle(const std::string& bundleHash, const std::string& l
 }
 
 void LCMManager::associateFileWithBundle(int fileId, int bundleId) {
+    std::lock_guard<std::mutex> lock(mutex_);
     const char* sql = "UPDATE file_index SET bundle_id = ? WHERE file_id = ?";
     sqlite3_stmt* stmt;
     int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
@@ -630,6 +1550,7 @@ void LCMManager::associateFileWithBundle(int fileId, int bundleId) {
 }
 
 int LCMManager::getOrCreateTokenProfileId(int fileTypeId, int ngramOrder, int vocabId, const std::string& statsBlob) {
+    std::lock_guard<std::mutex> lock(mutex_);
     // Simplified - in production, check for existing profile
     std::int64_t now = getCurrentTimestamp();
     std::ostringstream oss;
@@ -652,6 +1573,7 @@ int LCMManager::getOrCreateTokenProfileId(int fileTypeId, int ngramOrder, int vo
 }
 
 void LCMManager::updateTokenProfileUsage(int tokenProfileId) {
+    std::lock_guard<std::mutex> lock(mutex_);
     const char* sql = "UPDATE token_profiles SET usage_count = usage_count + 1 WHERE token_profile_id = ?";
     sqlite3_stmt* stmt;
     int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
@@ -663,9 +1585,10 @@ void LCMManager::updateTokenProfileUsage(int tokenProfileId) {
 }
 
 std::int64_t LCMManager::getTotalFilesTracked() const {
-    const char* sql = "SELECT COUNT(*) FROM file_index";
+    ReadLease reader(*readers_, mutex_);
+    const char* sql = "SELECT COALESCE(SUM(file_count), 0) FROM file_type_stats";
     sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
+    int rc = sqlite3_prepare_v2(reader->db, sql, -1, &stmt, nullptr);
     if (rc == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
         std::int64_t count = sqlite3_column_int64(stmt, 0);
         sqlite3_finalize(stmt);
@@ -676,9 +1599,10 @@ std::int64_t LCMManager::getTotalFilesTracked() const {
 }
 
 std::int64_t LCMManager::getTotalCorpusSize() const {
-    const char* sql = "SELECT SUM(size_bytes) FROM file_index";
+    ReadLease reader(*readers_, mutex_);
+    const char* sql = "SELECT COALESCE(SUM(total_bytes), 0) FROM file_type_stats";
     sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
+    int rc = sqlite3_prepare_v2(reader->db, sql, -1, &stmt, nullptr);
     if (rc == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
         std::int64_t size = sqlite3_column_int64(stmt, 0);
         sqlite3_finalize(stmt);
@@ -689,10 +1613,11 @@ std::int64_t LCMManager::getTotalCorpusSize() const {
 }
 
 std::vector<std::pair<int, std::int64_t>> LCMManager::getTopFileTypes(std::size_t limit) const {
-    const char* sql = "SELECT file_type_id, COUNT(*) as cnt FROM file_index GROUP BY file_type_id "
-                      "ORDER BY cnt DESC LIMIT ?";
+    ReadLease reader(*readers_, mutex_);
+    const char* sql = "SELECT file_type_id, file_count FROM file_type_stats WHERE file_count > 0 "
+                      "ORDER BY file_count DESC LIMIT ?";
     sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
+    int rc = sqlite3_prepare_v2(reader->db, sql, -1, &stmt, nullptr);
     if (rc != SQLITE_OK) {
         return {};
     }
@@ -708,13 +1633,141 @@ std::vector<std::pair<int, std::int64_t>> LCMManager::getTopFileTypes(std::size_
     return results;
 }
 
+LCMRetentionResult LCMManager::applyRetention(const LCMRetentionPolicy& policy) {
+    // The retention_* temporary tables belong to the writer connection and
+    // live across batches, while mutex_ is released between them
+    std::lock_guard<std::mutex> retentionLock(retentionMutex_);
+    LCMRetentionResult result;
+    auto exec = [this](const std::string& sql) {
+        char* errMsg = nullptr;
+        if (sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+            std::string error = errMsg ? errMsg : sqlite3_errmsg(db_);
+            sqlite3_free(errMsg);
+            throw std::runtime_error("LCM retention failed: " + error);
+        }
+    };
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        exec("CREATE TEMP TABLE IF NOT EXISTS retention_files (file_id INTEGER PRIMARY KEY);"
+             "CREATE TEMP TABLE IF NOT EXISTS retention_chunks (chunk_id INTEGER PRIMARY KEY, removed INTEGER);"
+             "CREATE TEMP TABLE IF NOT EXISTS retention_excess (chunk_id INTEGER PRIMARY KEY);"
+             "DELETE FROM retention_files; DELETE FROM retention_chunks; DELETE FROM retention_excess;");
+    }
+    
+    // Expired files. Chunks lose the occurrences in those files; chunks left
+    // with none are deleted, the others move their first position to a
+    // surviving occurrence.
+    if (policy.maxAgeDays.has_value()) {
+        const std::int64_t cutoff = getCurrentTimestamp() - std::int64_t{policy.maxAgeDays.value()} * 86400;
+        for (;;) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            Transaction txn(db_);
+            exec("DELETE FROM retention_files; DELETE FROM retention_chunks;"
+                 "INSERT INTO retention_files SELECT file_id FROM file_index WHERE last_seen_at < " +
+                 std::to_string(cutoff) + " LIMIT " + std::to_string(RETENTION_BATCH_ROWS));
+            if (sqlite3_changes(db_) == 0) {
+                txn.commit();
+                break;
+            }
+            exec("INSERT INTO retention_chunks SELECT chunk_id, COUNT(*) FROM chunk_occurrences "
+                 "WHERE file_id IN (SELECT file_id FROM retention_files) GROUP BY chunk_id;"
+                 "INSERT OR IGNORE INTO retention_chunks SELECT chunk_id, 0 FROM chunk_index "
+                 "WHERE file_id IN (SELECT file_id FROM retention_files);"
+                 "DELETE FROM chunk_occurrences WHERE file_id IN (SELECT file_id FROM retention_files);"
+                 "UPDATE chunk_index SET seen_count = MAX(1, seen_count - "
+                 "(SELECT removed FROM retention_chunks r WHERE r.chunk_id = chunk_index.chunk_id)) "
+                 "WHERE chunk_id IN (SELECT chunk_id FROM retention_chunks WHERE removed > 0);"
+                 "DELETE FROM retention_chunks WHERE EXISTS "
+                 "(SELECT 1 FROM chunk_occurrences o WHERE o.chunk_id = retention_chunks.chunk_id);"
+                 "UPDATE chunk_index SET (file_id, offset_bytes) = "
+                 "(SELECT o.file_id, o.offset_bytes FROM chunk_occurrences o "
+                 "WHERE o.chunk_id = chunk_index.chunk_id LIMIT 1) "
+                 "WHERE file_id IN (SELECT file_id FROM retention_files) "
+                 "AND chunk_id NOT IN (SELECT chunk_id FROM retention_chunks);"
+                 "DELETE FROM chunk_similarity WHERE chunk_id IN (SELECT chunk_id FROM retention_chunks);"
+                 "DELETE FROM chunk_index WHERE chunk_id IN (SELECT chunk_id FROM retention_chunks)");
+            result.chunksRemoved += sqlite3_changes(db_);
+            exec("DELETE FROM file_index WHERE file_id IN (SELECT file_id FROM retention_files)");
+            result.filesRemoved += sqlite3_changes(db_);
+            txn.commit();
+        }
+    }
+    
+    // Per-type cap: a chunk belongs to the type of its first file and is
+    // ranked by how often it has been seen. The excess is listed once (a
+    // read-only scan) and then deleted in batches.
+    if (policy.maxChunksPerFileType.has_value()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            exec("INSERT INTO retention_excess SELECT chunk_id FROM ("
+                 "SELECT c.chunk_id, ROW_NUMBER() OVER (PARTITION BY f.file_type_id "
+                 "ORDER BY c.seen_count DESC, c.chunk_id DESC) AS chunk_rank "
+                 "FROM chunk_index c JOIN file_index f ON f.file_id = c.file_id) "
+                 "WHERE chunk_rank > " + std::to_string(policy.maxChunksPerFileType.value()));
+        }
+        for (;;) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            Transaction txn(db_);
+            exec("DELETE FROM retention_chunks;"
+                 "INSERT INTO retention_chunks SELECT chunk_id, 0 FROM retention_excess LIMIT " +
+                 std::to_string(RETENTION_BATCH_ROWS));
+            if (sqlite3_changes(db_) == 0) {
+                txn.commit();
+                break;
+            }
+            exec("DELETE FROM retention_excess WHERE chunk_id IN (SELECT chunk_id FROM retention_chunks);"
+                 "DELETE FROM chunk_occurrences WHERE chunk_id IN (SELECT chunk_id FROM retention_chunks);"
+                 "DELETE FROM chunk_similarity WHERE chunk_id IN (SELECT chunk_id FROM retention_chunks);"
+                 "DELETE FROM chunk_index WHERE chunk_id IN (SELECT chunk_id FROM retention_chunks)");
+            result.chunksRemoved += sqlite3_changes(db_);
+            txn.commit();
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    exec("DROP TABLE IF EXISTS retention_files; DROP TABLE IF EXISTS retention_chunks;"
+         "DROP TABLE IF EXISTS retention_excess;");
+    return result;
+}
+
+std::int64_t LCMManager::reclaimSpace(std::int64_t maxPages) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::string sql = "PRAGMA incremental_vacuum(" + std::to_string(maxPages) + ")";
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::string error = errMsg ? errMsg : sqlite3_errmsg(db_);
+        sqlite3_free(errMsg);
+        throw std::runtime_error("Failed to reclaim LCM space: " + error);
+    }
+    
+    std::int64_t freePages = 0;
+    sqlite3_stmt* stmt = prepare("PRAGMA freelist_count");
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        freePages = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return freePages;
+}
+
 void LCMManager::vacuum() {
-    sqlite3_exec(db_, "VACUUM", nullptr, nullptr, nullptr);
+    std::lock_guard<std::mutex> lock(mutex_);
+    sqlite3_exec(db_, "PRAGMA auto_vacuum = INCREMENTAL; VACUUM", nullptr, nullptr, nullptr);
 }
 
 void LCMManager::optimize() {
+    std::lock_guard<std::mutex> lock(mutex_);
     sqlite3_exec(db_, "PRAGMA optimize", nullptr, nullptr, nullptr);
 }
 
+std::size_t LCMManager::getPreparedStatementCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::size_t count = 0;
+    for (sqlite3_stmt* stmt = sqlite3_next_stmt(db_, nullptr); stmt; stmt = sqlite3_next_stmt(db_, stmt)) {
+        ++count;
+    }
+    return count;
+}
+
 } // namespace rdx::core
 
@@ -9,6 +9,10 @@
 #include <cstdint>
 #include <span>
 #include <cstddef>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
 
 struct sqlite3;
 struct sqlite3_stmt;
@@ -26,6 +30,9 @@ struct FileInfo {
     std::optional<int> bundleId;
 };
 
+// A chunk occurrence. chunk_index keeps one row per distinct chunkHash
+// (first file/offset seen, seenCount accumulated); every occurrence is
+// recorded in chunk_occurrences.
 struct FileChunkInfo {
     int fileId;
     std::int64_t offsetBytes;
@@ -35,6 +42,7 @@ struct FileChunkInfo {
     int schemaId;
     std::optional<int> tokenProfileId;
     std::int64_t seenCount;
+    std::optional<std::uint64_t> simHash;  // computeSimHash; indexed for near-duplicate search when set
 };
 
 struct ChunkMatch {
@@ -50,10 +58,82 @@ struct FieldStatUpdate {
     std::string statsBlob; // JSON or binary stats
 };
 
+// One deferred LCM mutation (see LCMWriteQueue and LCMManager::applyWrites)
+struct LCMWrite {
+    enum class Kind {
+        RegisterFile,         // `file` and its `chunks`; chunk file ids are assigned
+        IncrementSchemaUsage  // `schemaId`
+    };
+    
+    Kind kind = Kind::RegisterFile;
+    FileInfo file{};
+    std::vector<FileChunkInfo> chunks;
+    int schemaId = 0;
+    
+    // RegisterFile: also count one use of file.schemaId, only if the file commits
+    bool countsSchemaUse = false;
+};
+
+// A write of an LCMManager::applyWrites batch that was rolled back
+struct LCMWriteFailure {
+    std::size_t index;  // Position in the batch
+    std::string error;
+};
+
+// How the LCM database trades durability for write speed. All profiles use
+// WAL journaling, so readers in other processes don't block the writer and
+// concurrent writers wait out busy_timeout instead of failing with SQLITE_BUSY.
+enum class LCMDurability {
+    Safe,      // synchronous=FULL: survives power loss after every commit
+    Balanced,  // synchronous=NORMAL: may lose the last commits on power loss, never corrupts
+    Ingest     // synchronous=OFF, large cache and mmap: bulk loading, rebuildable corpora
+};
+
+// Pragmas in effect on one connection, as SQLite reports them
+struct LCMConnectionSettings {
+    std::string journalMode;
+    int synchronous = 0;         // 0 = OFF, 1 = NORMAL, 2 = FULL
+    std::int64_t cacheSize = 0;  // Negative: KiB; positive: pages
+    std::int64_t mmapSize = 0;
+    int tempStore = 0;           // 0 = DEFAULT, 2 = MEMORY
+};
+
+// What LCMManager::applyRetention() keeps; unset limits keep everything
+struct LCMRetentionPolicy {
+    std::optional<int> maxAgeDays;                    // drop files not seen (last_seen_at) for this long
+    std::optional<std::size_t> maxChunksPerFileType;  // keep the most-seen chunks of each file type
+};
+
+struct LCMRetentionResult {
+    std::int64_t filesRemoved = 0;
+    std::int64_t chunksRemoved = 0;
+};
+
+// Safe to share between threads. Writes go through a single connection and
+// are serialized on an internal mutex. Read-only queries lease a connection
+// from a pool of read-only connections, so with WAL they run concurrently
+// with each other and with the writer, each on its own snapshot; databases
+// that can't be shared that way (in-memory, no WAL) read through the writer.
+// Hot queries run through statements prepared once per connection and reset
+// after each use.
+//
+// Hashes (content, path, chunk) are hex strings in the API and compact
+// BLOBs in the database; see LCM_SCHEMA.md.
+//
+// File types, schema ids and schema definitions are few and read for every
+// file, so they are cached in memory: warmed when the database opens, filled
+// on insert or on a miss that finds a row written by another process. Cache
+// hits take only a shared lock and never touch SQLite.
+//
+// Chunk rows are written as multi-row INSERTs inside explicit transactions.
+// LCMWriteQueue commits queued files in transactions of about
+// setChunkBatchSize() rows, so many small files cost a handful of commits
+// rather than one each. A file's rows are never split across transactions.
 class LCMManager {
 public:
-    static std::unique_ptr<LCMManager> createDefault();
-    explicit LCMManager(const std::filesystem::path& dbPath);
+    static std::unique_ptr<LCMManager> createDefault(LCMDurability durability = LCMDurability::Balanced);
+    explicit LCMManager(const std::filesystem::path& dbPath,
+                        LCMDurability durability = LCMDurability::Balanced);
     ~LCMManager();
     
     // Disable copy
@@ -66,16 +146,56 @@ public:
     
     void initializeSchema();
     
+    // Applies the profile's pragmas to the open connection
+    void setDurability(LCMDurability durability);
+    LCMDurability getDurability() const;
+    
+    // Settings of the writer connection, or of a connection leased from the
+    // reader pool (the writer's own when reads are not pooled)
+    LCMConnectionSettings getConnectionSettings(bool reader = false) const;
+    
     // File operations
     int registerFile(const FileInfo& info);
     std::optional<FileInfo> findFileByContentHash(const std::string& contentHash) const;
     void updateFileLastSeen(int fileId, std::int64_t timestamp);
     
+    // Registers the file and records its chunks (fileId is filled in) in one
+    // transaction. Returns the new file id.
+    int registerFileWithChunks(const FileInfo& info, std::vector<FileChunkInfo> chunks);
+    
     // Chunk operations
     void recordChunks(const std::vector<FileChunkInfo>& chunks);
+    
+    // Rows per transaction when LCMWriteQueue applies queued writes
+    void setChunkBatchSize(std::size_t rowsPerTransaction);
+    std::size_t getChunkBatchSize() const;
+    
+    // Applies queued mutations in one transaction; schema usage increments
+    // are summed per schema. Each file is registered under its own savepoint:
+    // one that fails is rolled back completely, its schema use is not
+    // counted, and it is reported in the result while the rest is applied.
+    // Errors that end the transaction itself roll back every write and are
+    // thrown, so either all the writes not reported as failed commit or none.
+    std::vector<LCMWriteFailure> applyWrites(std::span<LCMWrite> writes);
+    
+    // Exact matches on chunk_fingerprint / chunk_hash
     std::vector<ChunkMatch> findSimilarChunks(std::uint64_t fingerprint, std::size_t limit) const;
     std::vector<ChunkMatch> findSimilarChunksByHash(const std::string& chunkHash, std::size_t limit) const;
     
+    // Near-duplicates: chunks whose SimHash is within `maxDistance` bits of
+    // `signature`, closest first (similarity = 1 - distance / 64). Candidates
+    // come from LSH band buckets, so the cost depends on bucket sizes, not on
+    // the number of chunks. A match within LSH_BANDS - 1 bits shares a band
+    // with the signature and is found unless every bucket it shares holds more
+    // than LSH_BUCKET_SCAN_LIMIT chunks: only the newest that many are read per
+    // bucket. Larger distances are found only if some band happens to agree.
+    std::vector<ChunkMatch> findSimilarChunks(std::uint64_t signature, int maxDistance, std::size_t limit) const;
+    static constexpr int LSH_BANDS = 4;  // 16 bits each
+    
+    // Candidates read per band bucket, so a huge bucket (e.g. all-zero chunks)
+    // cannot turn one query into a table scan
+    static constexpr std::size_t LSH_BUCKET_SCAN_LIMIT = 4096;
+    
     // File type operations
     int getOrCreateFileTypeId(const std::string& name, const std::string& detectorSignature);
     std::string getFileTypeName(int fileTypeId) const;
@@ -95,33 +215,95 @@ public:
     int getOrCreateTokenProfileId(int fileTypeId, int ngramOrder, int vocabId, const std::string& statsBlob);
     void updateTokenProfileUsage(int tokenProfileId);
     
-    // Statistics
+    // Statistics, read from file_type_stats: O(file types), not O(files)
     std::int64_t getTotalFilesTracked() const;
     std::int64_t getTotalCorpusSize() const;
     std::vector<std::pair<int, std::int64_t>> getTopFileTypes(std::size_t limit) const; // returns (fileTypeId, count)
     
     // Database maintenance
+    
+    // Deletes the files and chunks the policy no longer keeps, together with
+    // their occurrences, similarity rows and chunks left without occurrences.
+    // Runs in transactions of RETENTION_BATCH_ROWS rows and releases the
+    // manager between them, so writers wait for one batch at most. Runs on
+    // several threads are serialized, as they share the writer connection's
+    // temporary tables. Freed pages stay in the file until reclaimSpace().
+    LCMRetentionResult applyRetention(const LCMRetentionPolicy& policy);
+    static constexpr int RETENTION_BATCH_ROWS = 1000;
+    
+    // Returns up to `maxPages` free pages to the filesystem (incremental
+    // auto-vacuum) and reports how many free pages remain. Cheap enough to
+    // call after every retention pass or on an idle timer.
+    std::int64_t reclaimSpace(std::int64_t maxPages = 1024);
+    
+    // Rewrites the whole database, blocking it for the duration. Also
+    // switches databases created before incremental auto-vacuum over to it.
     void vacuum();
     void optimize();
+    
+    // Statements prepared on the writer connection. Hot paths reuse theirs,
+    // so the count stops growing once each has run.
+    std::size_t getPreparedStatementCount() const;
 
 private:
     sqlite3* db_;
     std::filesystem::path dbPath_;
     
     void createTables();
+    void migrateSchema();
     void createIndices();
     void prepareStatements();
+    void applyDurability(LCMDurability durability);
     
-    // Prepared statements (simplified - in production, use proper prepared statement management)
+    class Transaction;
+    int insertFile(const FileInfo& info);
+    void insertChunks(std::span<const FileChunkInfo> chunks);
+    sqlite3_stmt* chunkInsertStatement(std::size_t rows);
+    sqlite3_stmt* occurrenceInsertStatement(std::size_t rows);
+    void insertSimilarity(std::int64_t chunkId, std::uint64_t simHash);
+    
+    // Prepared statements, owned by this manager
     mutable sqlite3_stmt* stmtRegisterFile_;
-    mutable sqlite3_stmt* stmtFindFileByHash_;
-    mutable sqlite3_stmt* stmtRecordChunk_;
-    mutable sqlite3_stmt* stmtFindChunksByFingerprint_;
+    mutable sqlite3_stmt* stmtUpdateFileLastSeen_;
+    
+    // Multi-row chunk and occurrence INSERTs indexed by row count; sizes other
+    // than the full one are prepared on first use, for the tail of a file
+    std::vector<sqlite3_stmt*> stmtRecordChunkRows_;
+    std::vector<sqlite3_stmt*> stmtRecordOccurrenceRows_;
+    
+    mutable sqlite3_stmt* stmtInsertSimilarity_;
     mutable sqlite3_stmt* stmtGetOrCreateFileType_;
+    mutable sqlite3_stmt* stmtInsertFileType_;
     mutable sqlite3_stmt* stmtGetOrCreateSchema_;
+    mutable sqlite3_stmt* stmtInsertSchema_;
     mutable sqlite3_stmt* stmtIncrementSchemaUsage_;
+    mutable std::mutex mutex_;  // Guards the writer connection and its statements
+    std::mutex retentionMutex_;  // Held for a whole applyRetention run, before mutex_
+    std::size_t chunkBatchSize_;
+    LCMDurability durability_;
+    
+    // Read-through caches; lock order is mutex_ before cacheMutex_
+    struct SchemaKeyHash {
+        std::size_t operator()(const std::pair<std::string, int>& key) const noexcept {
+            return std::hash<std::string>{}(key.first) ^ (std::hash<int>{}(key.second) * 0x9e3779b97f4a7c15ULL);
+        }
+    };
+    mutable std::shared_mutex cacheMutex_;
+    mutable std::unordered_map<std::string, int> fileTypeIds_;
+    mutable std::unordered_map<int, std::string> fileTypeNames_;
+    mutable std::unordered_map<std::pair<std::string, int>, int, SchemaKeyHash> schemaIds_;
+    mutable std::unordered_map<int, std::string> schemaDefinitions_;
+    
+    void warmCaches();
+    
+    // Read-only connections; a ReadLease holds one for the length of a call
+    class ReaderPool;
+    class ReadLease;
+    std::unique_ptr<ReaderPool> readers_;
     
+    sqlite3_stmt* prepare(const char* sql) const;
     void finalizeStatements();
+    void takeStatements(LCMManager& other);
 };
 
 } // namespace rdx::core
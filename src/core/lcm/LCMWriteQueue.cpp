@@ -0,0 +1,161 @@
+#include "lcm/LCMWriteQueue.h"
+#include <algorithm>
+#include <bit>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace rdx::core {
+
+LCMWriteQueue::LCMWriteQueue(LCMManager& lcm, std::size_t capacity)
+    : lcm_(lcm)
+    , capacity_(std::bit_ceil(std::max<std::size_t>(capacity, 2)))
+    , slots_(std::make_unique<Slot[]>(capacity_)) {
+    for (std::size_t i = 0; i < capacity_; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    writer_ = std::thread([this] { run(); });
+}
+
+LCMWriteQueue::~LCMWriteQueue() {
+    try {
+        flush();
+    } catch (const std::exception& e) {
+        std::cerr << "LCMWriteQueue: " << e.what() << std::endl;
+    }
+    stopping_.store(true);
+    published_.fetch_add(1);
+    published_.notify_one();
+    writer_.join();
+}
+
+bool LCMWriteQueue::tryPush(LCMWrite& write) {
+    const std::uint64_t mask = capacity_ - 1;
+    std::uint64_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = slots_[pos & mask];
+        std::uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::int64_t>(sequence - pos);
+        if (diff == 0) {
+            if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.write = std::move(write);
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;  // Full: the slot still holds the write from one lap ago
+        } else {
+            pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool LCMWriteQueue::tryPop(LCMWrite& write) {
+    Slot& slot = slots_[dequeuePos_ & (capacity_ - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != dequeuePos_ + 1) {
+        return false;  // Empty, or the producer has claimed but not filled it yet
+    }
+    write = std::move(slot.write);
+    slot.sequence.store(dequeuePos_ + capacity_, std::memory_order_release);
+    ++dequeuePos_;
+    return true;
+}
+
+void LCMWriteQueue::post(LCMWrite write) {
+    for (;;) {
+        std::uint64_t freed = freed_.load();
+        if (tryPush(write)) {
+            break;
+        }
+        freed_.wait(freed);  // Backpressure
+    }
+    published_.fetch_add(1);
+    published_.notify_one();
+}
+
+void LCMWriteQueue::flush() {
+    // Every write posted before this point has a position below `target`,
+    // and the writer applies positions in order
+    const std::uint64_t target = enqueuePos_.load();
+    std::uint64_t applied = applied_.load();
+    while (applied < target) {
+        applied_.wait(applied);
+        applied = applied_.load();
+    }
+    
+    std::lock_guard<std::mutex> lock(errorMutex_);
+    const std::uint64_t failed = failedWrites_.load();
+    if (failed > reportedFailures_) {
+        const std::uint64_t unreported = failed - reportedFailures_;
+        reportedFailures_ = failed;
+        throw std::runtime_error("LCM updates failed for " + std::to_string(unreported) +
+                                 " write(s): " + lastError_);
+    }
+}
+
+std::string LCMWriteQueue::getLastError() const {
+    std::lock_guard<std::mutex> lock(errorMutex_);
+    return lastError_;
+}
+
+void LCMWriteQueue::run() {
+    std::vector<LCMWrite> batch;
+    batch.reserve(capacity_);
+    
+    for (;;) {
+        const std::uint64_t published = published_.load();
+        LCMWrite write;
+        while (batch.size() < capacity_ && tryPop(write)) {
+            batch.push_back(std::move(write));
+        }
+        
+        if (batch.empty()) {
+            if (stopping_.load()) {
+                return;
+            }
+            published_.wait(published);
+            continue;
+        }
+        
+        // Slots are free again; let blocked producers refill them while
+        // this batch is committed
+        freed_.fetch_add(batch.size());
+        freed_.notify_all();
+        
+        // One transaction per slice of about getChunkBatchSize() rows, cut
+        // between writes. Failed files were rolled back individually; if a
+        // transaction itself failed, none of its slice was committed.
+        const std::size_t rowsPerTransaction = lcm_.getChunkBatchSize();
+        for (std::size_t begin = 0; begin < batch.size();) {
+            std::size_t end = begin;
+            std::size_t rows = 0;
+            do {
+                rows += batch[end].chunks.size() + 1;
+                ++end;
+            } while (end < batch.size() && rows < rowsPerTransaction);
+            
+            std::span<LCMWrite> slice(batch.data() + begin, end - begin);
+            try {
+                auto failures = lcm_.applyWrites(slice);
+                if (!failures.empty()) {
+                    std::lock_guard<std::mutex> lock(errorMutex_);
+                    lastError_ = failures.back().error;
+                    failedWrites_.fetch_add(failures.size());
+                }
+            } catch (const std::exception& e) {
+                std::lock_guard<std::mutex> lock(errorMutex_);
+                lastError_ = e.what();
+                failedWrites_.fetch_add(slice.size());
+            }
+            begin = end;
+        }
+        
+        applied_.fetch_add(batch.size());
+        applied_.notify_all();
+        batch.clear();
+    }
+}
+
+} // namespace rdx::core
@@ -0,0 +1,84 @@
+#ifndef RDX_LCMWRITEQUEUE_H
+#define RDX_LCMWRITEQUEUE_H
+
+#include "lcm/LCMManager.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace rdx::core {
+
+// Write-behind buffer for LCM mutations. Producers post into a bounded
+// lock-free ring and return immediately; a background thread drains
+// whatever has accumulated and applies it through LCMManager::applyWrites
+// in transactions of about LCMManager::getChunkBatchSize() rows, so many
+// files share one transaction. When the ring is full, post() blocks until
+// the writer catches up.
+//
+// A file whose registration fails is rolled back on its own and the rest of
+// its transaction still commits; a failed transaction counts all its writes. Failures are counted (getFailedWrites/getLastError)
+// and thrown from the next flush(), so producers learn that the LCM is
+// missing files instead of the loss going unnoticed.
+// The LCMManager must outlive the queue.
+class LCMWriteQueue {
+public:
+    explicit LCMWriteQueue(LCMManager& lcm, std::size_t capacity = 1024);
+    
+    // Flushes, then stops the writer thread; failures not yet reported by
+    // flush() are only logged to stderr there
+    ~LCMWriteQueue();
+    
+    LCMWriteQueue(const LCMWriteQueue&) = delete;
+    LCMWriteQueue& operator=(const LCMWriteQueue&) = delete;
+    
+    // Safe to call from any number of threads
+    void post(LCMWrite write);
+    
+    // Barrier: returns once everything posted before the call has been
+    // applied or rolled back. Throws if writes failed since the last flush
+    // that threw; each failure is reported once
+    void flush();
+    
+    std::size_t getCapacity() const { return capacity_; }
+    std::uint64_t getFailedWrites() const { return failedWrites_.load(); }
+    std::string getLastError() const;
+
+private:
+    // Bounded MPSC ring (Vyukov): each slot's sequence says whether it is
+    // free for position `pos` (== pos) or holds the write for `pos` (== pos + 1)
+    struct Slot {
+        std::atomic<std::uint64_t> sequence;
+        LCMWrite write;
+    };
+    
+    LCMManager& lcm_;
+    std::size_t capacity_;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<std::uint64_t> enqueuePos_{0};
+    std::uint64_t dequeuePos_ = 0;          // Writer thread only
+    
+    // Counters producers and the writer wait on (std::atomic::wait)
+    std::atomic<std::uint64_t> published_{0};
+    std::atomic<std::uint64_t> freed_{0};
+    std::atomic<std::uint64_t> applied_{0};
+    std::atomic<bool> stopping_{false};
+    
+    std::atomic<std::uint64_t> failedWrites_{0};
+    mutable std::mutex errorMutex_;
+    std::string lastError_;
+    std::uint64_t reportedFailures_ = 0;    // Guarded by errorMutex_
+    
+    std::thread writer_;
+    
+    bool tryPush(LCMWrite& write);
+    bool tryPop(LCMWrite& write);
+    void run();
+};
+
+} // namespace rdx::core
+
+#endif // RDX_LCMWRITEQUEUE_H
@@ -29,6 +29,9 @@ public:
     // Register a new schema (adds to LCM)
     int registerSchema(const SchemaDefinition& schema);
     
+    // Serialized form stored in the LCM and embedded in archives
+    std::string schemaToJSON(const SchemaDefinition& schema) const;
+    
     // Schema constants
     static constexpr int SCHEMA_PE32_ID = 1;
     static constexpr int SCHEMA_JSON_GENERIC_ID = 2;
@@ -51,7 +54,6 @@ private:
     SchemaDefinition createChunkedBinarySchema();
     SchemaDefinition createUnstructuredBinarySchema();
     
-    std::string schemaToJSON(const SchemaDefinition& schema) const;
     SchemaDefinition schemaFromJSON(const std::string& json) const;
 };
 
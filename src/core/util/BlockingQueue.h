@@ -0,0 +1,112 @@
+#ifndef RDX_BLOCKINGQUEUE_H
+#define RDX_BLOCKINGQUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace rdx::core {
+
+// Multi-producer/multi-consumer queue for handing work between pipeline
+// stages. pop() blocks until an item arrives or the queue is closed. With a
+// capacity, push() blocks while the queue is full, so a fast producer can't
+// run arbitrarily far ahead of its consumers; 0 leaves the queue unbounded.
+template <typename T>
+class BlockingQueue {
+public:
+    explicit BlockingQueue(std::size_t capacity = 0) : capacity_(capacity) {}
+    
+    // Items pushed after close() are dropped
+    void push(T item) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (capacity_ > 0) {
+                space_.wait(lock, [this] { return items_.size() < capacity_ || closed_; });
+            }
+            if (closed_) {
+                return;
+            }
+            items_.push_back(std::move(item));
+        }
+        available_.notify_one();
+    }
+    
+    // Returns std::nullopt once the queue is closed and drained
+    std::optional<T> pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        available_.wait(lock, [this] { return !items_.empty() || closed_; });
+        if (items_.empty()) {
+            return std::nullopt;
+        }
+        T item = std::move(items_.front());
+        items_.pop_front();
+        lock.unlock();
+        if (capacity_ > 0) {
+            space_.notify_one();
+        }
+        return item;
+    }
+    
+    // No more items will be pushed; wakes all waiting consumers and producers
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        available_.notify_all();
+        space_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable available_;
+    std::condition_variable space_;
+    std::deque<T> items_;
+    std::size_t capacity_;
+    bool closed_ = false;
+};
+
+// Caps the number of bytes held between two pipeline stages. A single item
+// larger than the whole budget is still admitted once nothing else is held,
+// so oversized entries slow the pipeline down instead of deadlocking it.
+class ByteBudget {
+public:
+    explicit ByteBudget(std::size_t capacity) : capacity_(capacity) {}
+    
+    void acquire(std::size_t bytes) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        released_.wait(lock, [&] { return inUse_ == 0 || inUse_ + bytes <= capacity_; });
+        inUse_ += bytes;
+    }
+    
+    // Non-blocking acquire; returns false if the bytes do not fit right now
+    bool tryAcquire(std::size_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (inUse_ != 0 && inUse_ + bytes > capacity_) {
+            return false;
+        }
+        inUse_ += bytes;
+        return true;
+    }
+    
+    void release(std::size_t bytes) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            inUse_ -= bytes;
+        }
+        released_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable released_;
+    std::size_t capacity_;
+    std::size_t inUse_ = 0;
+};
+
+} // namespace rdx::core
+
+#endif // RDX_BLOCKINGQUEUE_H
@@ -0,0 +1,96 @@
+#include "util/DirectoryWalker.h"
+#include "util/ParallelFor.h"
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rdx::core {
+
+void walkDirectory(const std::filesystem::path& root,
+                   const DirectoryWalkOptions& options,
+                   const std::function<void(const std::filesystem::path&)>& onFile,
+                   const std::function<void(const std::filesystem::path&, const std::string&)>& onError) {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::filesystem::path> pending{root};  // LIFO keeps the list short on deep trees
+    std::size_t busy = 0;
+    bool stopped = false;
+    std::exception_ptr firstError;
+    
+    auto listDirectory = [&](const std::filesystem::path& dir, std::vector<std::filesystem::path>& subdirs) {
+        std::error_code ec;
+        std::filesystem::directory_iterator it(dir, std::filesystem::directory_options::skip_permission_denied, ec);
+        for (; !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+            const std::filesystem::directory_entry& entry = *it;
+            std::error_code typeError;
+            if (entry.is_symlink(typeError)) {
+                continue;
+            }
+            if (entry.is_directory(typeError)) {
+                subdirs.push_back(entry.path());
+            } else if (entry.is_regular_file(typeError)) {
+                onFile(entry.path());
+            }
+        }
+        if (ec && onError) {
+            onError(dir, ec.message());
+        }
+    };
+    
+    auto worker = [&]() {
+        std::vector<std::filesystem::path> subdirs;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            // Done once nothing is queued and nobody can queue more
+            changed.wait(lock, [&] { return stopped || !pending.empty() || busy == 0; });
+            if (stopped || pending.empty()) {
+                return;
+            }
+            
+            std::filesystem::path dir = std::move(pending.back());
+            pending.pop_back();
+            ++busy;
+            lock.unlock();
+            
+            subdirs.clear();
+            try {
+                listDirectory(dir, subdirs);
+            } catch (...) {
+                lock.lock();
+                if (!firstError) {
+                    firstError = std::current_exception();
+                }
+                stopped = true;
+                --busy;
+                changed.notify_all();
+                return;
+            }
+            
+            lock.lock();
+            for (auto& subdir : subdirs) {
+                pending.push_back(std::move(subdir));
+            }
+            --busy;
+            changed.notify_all();
+        }
+    };
+    
+    unsigned workers = resolveThreadCount(options.threadCount);
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (unsigned t = 1; t < workers; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    if (firstError) {
+        std::rethrow_exception(firstError);
+    }
+}
+
+} // namespace rdx::core
@@ -0,0 +1,34 @@
+#ifndef RDX_DIRECTORYWALKER_H
+#define RDX_DIRECTORYWALKER_H
+
+#include <filesystem>
+#include <functional>
+#include <string>
+
+namespace rdx::core {
+
+struct DirectoryWalkOptions {
+    // Directories listed concurrently; 0 means one per hardware thread.
+    // Listing is mostly waiting on metadata I/O, so more threads than cores
+    // can pay off on network or cold storage.
+    unsigned threadCount = 0;
+};
+
+// Finds every regular file below `root`. Each worker lists one directory at a
+// time and pushes its subdirectories back onto a shared work list, so wide
+// and deep trees are both spread across the pool. File types come from the
+// directory listing itself (d_type), so no per-file stat is needed on
+// filesystems that report them.
+//
+// Symlinks are skipped, not followed. `onFile` and `onError` are called
+// concurrently from the workers; unreadable directories go to `onError` and
+// the walk continues. An exception thrown by `onFile` stops the walk and is
+// rethrown.
+void walkDirectory(const std::filesystem::path& root,
+                   const DirectoryWalkOptions& options,
+                   const std::function<void(const std::filesystem::path&)>& onFile,
+                   const std::function<void(const std::filesystem::path&, const std::string&)>& onError = {});
+
+} // namespace rdx::core
+
+#endif // RDX_DIRECTORYWALKER_H
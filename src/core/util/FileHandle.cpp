@@ -0,0 +1,210 @@
+#include "util/FileHandle.h"
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <winioctl.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rdx::core {
+
+FileHandle::FileHandle(const std::filesystem::path& path, Mode mode)
+    : path_(path) {
+#ifdef _WIN32
+    DWORD access = GENERIC_READ;
+    DWORD disposition = OPEN_EXISTING;
+    if (mode == Mode::Write) {
+        access = GENERIC_WRITE;
+        disposition = CREATE_ALWAYS;
+    } else if (mode == Mode::ReadWrite) {
+        access = GENERIC_READ | GENERIC_WRITE;
+        disposition = OPEN_ALWAYS;
+    }
+    
+    HANDLE h = CreateFileW(path.wstring().c_str(), access, FILE_SHARE_READ, nullptr,
+                           disposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Failed to open file: " + path.string());
+    }
+    handle_ = h;
+#else
+    int flags = O_RDONLY;
+    if (mode == Mode::Write) {
+        flags = O_WRONLY | O_CREAT | O_TRUNC;
+    } else if (mode == Mode::ReadWrite) {
+        flags = O_RDWR | O_CREAT;
+    }
+    
+    fd_ = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Failed to open file: " + path.string() + ": " + std::strerror(errno));
+    }
+#endif
+}
+
+FileHandle::~FileHandle() {
+    close();
+}
+
+FileHandle::FileHandle(FileHandle&& other) noexcept
+    : path_(std::move(other.path_))
+#ifdef _WIN32
+    , handle_(std::exchange(other.handle_, nullptr)) {
+#else
+    , fd_(std::exchange(other.fd_, -1)) {
+#endif
+}
+
+FileHandle& FileHandle::operator=(FileHandle&& other) noexcept {
+    if (this != &other) {
+        close();
+        path_ = std::move(other.path_);
+#ifdef _WIN32
+        handle_ = std::exchange(other.handle_, nullptr);
+#else
+        fd_ = std::exchange(other.fd_, -1);
+#endif
+    }
+    return *this;
+}
+
+bool FileHandle::isOpen() const {
+#ifdef _WIN32
+    return handle_ != nullptr;
+#else
+    return fd_ >= 0;
+#endif
+}
+
+void FileHandle::close() {
+#ifdef _WIN32
+    if (handle_) {
+        CloseHandle(static_cast<HANDLE>(handle_));
+        handle_ = nullptr;
+    }
+#else
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+#endif
+}
+
+void FileHandle::readAt(std::int64_t offset, void* buffer, std::size_t size) const {
+    auto* dst = static_cast<char*>(buffer);
+    while (size > 0) {
+#ifdef _WIN32
+        OVERLAPPED ov{};
+        ov.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+        ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD chunk = size > 0x40000000 ? 0x40000000 : static_cast<DWORD>(size);
+        DWORD got = 0;
+        if (!ReadFile(static_cast<HANDLE>(handle_), dst, chunk, &got, &ov) && GetLastError() != ERROR_HANDLE_EOF) {
+            throw std::runtime_error("Failed to read file: " + path_.string());
+        }
+#else
+        ssize_t got = ::pread(fd_, dst, size, static_cast<off_t>(offset));
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Failed to read file: " + path_.string() + ": " + std::strerror(errno));
+        }
+#endif
+        if (got == 0) {
+            throw std::runtime_error("Unexpected end of file: " + path_.string());
+        }
+        dst += got;
+        offset += got;
+        size -= static_cast<std::size_t>(got);
+    }
+}
+
+void FileHandle::writeAt(std::int64_t offset, const void* buffer, std::size_t size) {
+    const auto* src = static_cast<const char*>(buffer);
+    while (size > 0) {
+#ifdef _WIN32
+        OVERLAPPED ov{};
+        ov.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+        ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD chunk = size > 0x40000000 ? 0x40000000 : static_cast<DWORD>(size);
+        DWORD written = 0;
+        if (!WriteFile(static_cast<HANDLE>(handle_), src, chunk, &written, &ov)) {
+            throw std::runtime_error("Failed to write file: " + path_.string());
+        }
+#else
+        ssize_t written = ::pwrite(fd_, src, size, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Failed to write file: " + path_.string() + ": " + std::strerror(errno));
+        }
+#endif
+        src += written;
+        offset += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+std::int64_t FileHandle::size() const {
+#ifdef _WIN32
+    LARGE_INTEGER li;
+    if (!GetFileSizeEx(static_cast<HANDLE>(handle_), &li)) {
+        throw std::runtime_error("Failed to query file size: " + path_.string());
+    }
+    return static_cast<std::int64_t>(li.QuadPart);
+#else
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        throw std::runtime_error("Failed to query file size: " + path_.string());
+    }
+    return static_cast<std::int64_t>(st.st_size);
+#endif
+}
+
+void FileHandle::adviseSequential() const {
+#if defined(POSIX_FADV_SEQUENTIAL)
+    ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+void FileHandle::prefetch(std::int64_t offset, std::int64_t length) const {
+#if defined(POSIX_FADV_WILLNEED)
+    // Starts asynchronous readahead into the page cache and returns immediately
+    ::posix_fadvise(fd_, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_WILLNEED);
+#endif
+}
+
+void FileHandle::resize(std::int64_t newSize) {
+#ifdef _WIN32
+    FILE_END_OF_FILE_INFO info;
+    info.EndOfFile.QuadPart = newSize;
+    if (!SetFileInformationByHandle(static_cast<HANDLE>(handle_), FileEndOfFileInfo, &info, sizeof(info))) {
+        throw std::runtime_error("Failed to resize file: " + path_.string());
+    }
+#else
+    if (::ftruncate(fd_, static_cast<off_t>(newSize)) != 0) {
+        throw std::runtime_error("Failed to resize file: " + path_.string() + ": " + std::strerror(errno));
+    }
+#endif
+}
+
+void FileHandle::markSparse() {
+#ifdef _WIN32
+    // NTFS only skips allocating unwritten ranges of files flagged as sparse.
+    // Best effort: on filesystems without sparse support the data is just zeros.
+    DWORD returned = 0;
+    DeviceIoControl(static_cast<HANDLE>(handle_), FSCTL_SET_SPARSE, nullptr, 0, nullptr, 0, &returned, nullptr);
+#endif
+}
+
+} // namespace rdx::core
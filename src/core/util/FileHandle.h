@@ -0,0 +1,73 @@
+#ifndef RDX_FILEHANDLE_H
+#define RDX_FILEHANDLE_H
+
+#include <filesystem>
+#include <cstdint>
+#include <cstddef>
+
+namespace rdx::core {
+
+// Thin RAII wrapper over a native file descriptor/handle with positional I/O.
+// readAt/writeAt do not share a file position, so they may be called
+// concurrently from several threads on the same handle.
+class FileHandle {
+public:
+    enum class Mode {
+        Read,       // Existing file, read-only
+        Write,      // Create or truncate, write-only
+        ReadWrite   // Create if missing, keep contents
+    };
+    
+    FileHandle() = default;
+    FileHandle(const std::filesystem::path& path, Mode mode);
+    ~FileHandle();
+    
+    // Disable copy
+    FileHandle(const FileHandle&) = delete;
+    FileHandle& operator=(const FileHandle&) = delete;
+    
+    // Enable move
+    FileHandle(FileHandle&& other) noexcept;
+    FileHandle& operator=(FileHandle&& other) noexcept;
+    
+    bool isOpen() const;
+    void close();
+    
+    // Reads exactly `size` bytes at `offset`; throws on I/O error or EOF
+    void readAt(std::int64_t offset, void* buffer, std::size_t size) const;
+    
+    // Writes exactly `size` bytes at `offset`; throws on I/O error
+    void writeAt(std::int64_t offset, const void* buffer, std::size_t size);
+    
+    std::int64_t size() const;
+    
+    // Access pattern hints for the OS page cache (no-ops where unsupported)
+    void adviseSequential() const;
+    void prefetch(std::int64_t offset, std::int64_t length) const;
+    
+    // Extends (with zeros) or truncates the file to `newSize` bytes
+    void resize(std::int64_t newSize);
+    
+    // Lets ranges that are never written stay unallocated. POSIX filesystems
+    // do this for every file; Windows needs the file flagged first.
+    void markSparse();
+    
+    const std::filesystem::path& path() const { return path_; }
+    
+#ifndef _WIN32
+    // Raw descriptor for backends that drive the kernel directly (io_uring)
+    int descriptor() const { return fd_; }
+#endif
+
+private:
+    std::filesystem::path path_;
+#ifdef _WIN32
+    void* handle_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+} // namespace rdx::core
+
+#endif // RDX_FILEHANDLE_H
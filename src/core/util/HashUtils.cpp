@@ -1,8 +1,11 @@
 #include "util/HashUtils.h"
+#include "util/FileHandle.h"
+#include <vector>
 #include <sstream>
 #include <iomanip>
 #include <functional>
 #include <cstring>
+#include <algorithm>
 
 namespace rdx::core {
 
@@ -54,6 +57,211 @@ std::uint64_t computeChunkFingerprint(std::span<const std::byte> data) {
     return hash;
 }
 
+namespace {
+
+std::uint64_t mixShingle(std::uint64_t x) {
+    // splitmix64 finalizer
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Keep shingles whose hash has these low bits clear (1 in 16). Sampling by
+// content rather than position keeps the feature set stable under
+// insertions and shifts, and cuts the per-bit work sixteenfold.
+constexpr std::uint64_t SIMHASH_SAMPLE_MASK = 0xF;
+
+} // namespace
+
+std::uint64_t computeSimHash(std::span<const std::byte> data) {
+    constexpr std::size_t SHINGLE = sizeof(std::uint64_t);
+    if (data.size() < SHINGLE) {
+        return computeXXH64(data);
+    }
+    
+    std::int32_t weights[64] = {};
+    std::size_t features = 0;
+    for (std::size_t i = 0; i + SHINGLE <= data.size(); ++i) {
+        std::uint64_t shingle;
+        std::memcpy(&shingle, data.data() + i, SHINGLE);
+        std::uint64_t h = mixShingle(shingle);
+        if ((h & SIMHASH_SAMPLE_MASK) != 0) {
+            continue;
+        }
+        
+        // The sampled low bits are always zero; fold in high bits instead
+        h ^= h >> 32;
+        for (int bit = 0; bit < 64; ++bit) {
+            weights[bit] += ((h >> bit) & 1) ? 1 : -1;
+        }
+        ++features;
+    }
+    
+    if (features == 0) {
+        return computeXXH64(data);
+    }
+    
+    std::uint64_t signature = 0;
+    for (int bit = 0; bit < 64; ++bit) {
+        if (weights[bit] > 0) {
+            signature |= std::uint64_t(1) << bit;
+        }
+    }
+    return signature;
+}
+
+namespace {
+
+constexpr std::uint64_t XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+constexpr std::uint64_t XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr std::uint64_t XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+constexpr std::uint64_t XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr std::uint64_t XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+inline std::uint64_t rotl64(std::uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline std::uint64_t readLE64(const std::byte* p) {
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline std::uint32_t readLE32(const std::byte* p) {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline std::uint64_t xxhRound(std::uint64_t acc, std::uint64_t input) {
+    acc += input * XXH_PRIME64_2;
+    acc = rotl64(acc, 31);
+    return acc * XXH_PRIME64_1;
+}
+
+inline std::uint64_t xxhMergeRound(std::uint64_t acc, std::uint64_t val) {
+    acc ^= xxhRound(0, val);
+    return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+// Consumes the remaining (< 32) bytes and applies the final avalanche
+std::uint64_t xxhFinalize(std::uint64_t h, const std::byte* p, std::size_t len) {
+    while (len >= 8) {
+        h ^= xxhRound(0, readLE64(p));
+        h = rotl64(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+        p += 8;
+        len -= 8;
+    }
+    if (len >= 4) {
+        h ^= static_cast<std::uint64_t>(readLE32(p)) * XXH_PRIME64_1;
+        h = rotl64(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        p += 4;
+        len -= 4;
+    }
+    while (len > 0) {
+        h ^= static_cast<std::uint64_t>(*p) * XXH_PRIME64_5;
+        h = rotl64(h, 11) * XXH_PRIME64_1;
+        ++p;
+        --len;
+    }
+    
+    h ^= h >> 33;
+    h *= XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+std::uint64_t xxhMergeAccumulators(const std::uint64_t acc[4]) {
+    std::uint64_t h = rotl64(acc[0], 1) + rotl64(acc[1], 7) + rotl64(acc[2], 12) + rotl64(acc[3], 18);
+    for (int i = 0; i < 4; ++i) {
+        h = xxhMergeRound(h, acc[i]);
+    }
+    return h;
+}
+
+} // namespace
+
+std::uint64_t computeXXH64(std::span<const std::byte> data, std::uint64_t seed) {
+    XXH64State state(seed);
+    state.update(data);
+    return state.digest();
+}
+
+XXH64State::XXH64State(std::uint64_t seed)
+    : acc_{seed + XXH_PRIME64_1 + XXH_PRIME64_2, seed + XXH_PRIME64_2, seed, seed - XXH_PRIME64_1}
+    , seed_(seed)
+    , totalLength_(0)
+    , buffer_{}
+    , bufferSize_(0) {
+}
+
+void XXH64State::update(std::span<const std::byte> data) {
+    if (data.empty()) {
+        return;
+    }
+    
+    const std::byte* p = data.data();
+    std::size_t len = data.size();
+    totalLength_ += len;
+    
+    // Top up a partially filled stripe first
+    if (bufferSize_ > 0) {
+        std::size_t take = std::min(len, buffer_.size() - bufferSize_);
+        std::memcpy(buffer_.data() + bufferSize_, p, take);
+        bufferSize_ += take;
+        p += take;
+        len -= take;
+        if (bufferSize_ < buffer_.size()) {
+            return;
+        }
+        for (int i = 0; i < 4; ++i) {
+            acc_[i] = xxhRound(acc_[i], readLE64(buffer_.data() + i * 8));
+        }
+        bufferSize_ = 0;
+    }
+    
+    // Full 32-byte stripes straight from the input
+    while (len >= 32) {
+        for (int i = 0; i < 4; ++i) {
+            acc_[i] = xxhRound(acc_[i], readLE64(p + i * 8));
+        }
+        p += 32;
+        len -= 32;
+    }
+    
+    if (len > 0) {
+        std::memcpy(buffer_.data(), p, len);
+        bufferSize_ = len;
+    }
+}
+
+std::uint64_t XXH64State::digest() const {
+    std::uint64_t h = totalLength_ >= 32 ? xxhMergeAccumulators(acc_) : seed_ + XXH_PRIME64_5;
+    h += totalLength_;
+    return xxhFinalize(h, buffer_.data(), bufferSize_);
+}
+
+std::uint64_t computeFileXXH64(const std::filesystem::path& path, std::int64_t& outSize) {
+    FileHandle file(path, FileHandle::Mode::Read);
+    outSize = file.size();
+    
+    XXH64State hash;
+    std::vector<std::byte> buffer(1024 * 1024);
+    for (std::int64_t offset = 0; offset < outSize;) {
+        std::size_t chunk = static_cast<std::size_t>(std::min<std::int64_t>(outSize - offset, buffer.size()));
+        file.readAt(offset, buffer.data(), chunk);
+        hash.update(std::span<const std::byte>(buffer.data(), chunk));
+        offset += static_cast<std::int64_t>(chunk);
+    }
+    return hash.digest();
+}
+
 std::string computeContentHash(std::span<const std::byte> data) {
     return computeSHA256(data);
 }
@@ -2,6 +2,7 @@
 #define RDX_HASHUTILS_H
 
 #include <cstdint>
+#include <filesystem>
 #include <string>
 #include <span>
 #include <cstddef>
@@ -18,6 +19,34 @@ std::array<std::byte, 32> computeSHA256Binary(std::span<const std::byte> data);
 // Fast hash for chunk fingerprints (64-bit)
 std::uint64_t computeChunkFingerprint(std::span<const std::byte> data);
 
+// 64-bit SimHash over 8-byte shingles: similar data gives signatures with a
+// small Hamming distance (used for near-duplicate chunk search in the LCM)
+std::uint64_t computeSimHash(std::span<const std::byte> data);
+
+// XXH64 checksum (block integrity checks)
+std::uint64_t computeXXH64(std::span<const std::byte> data, std::uint64_t seed = 0);
+
+// Incremental XXH64 for data that arrives in pieces; digest() matches
+// computeXXH64 over the concatenation of everything passed to update()
+class XXH64State {
+public:
+    explicit XXH64State(std::uint64_t seed = 0);
+    
+    void update(std::span<const std::byte> data);
+    std::uint64_t digest() const;
+
+private:
+    std::uint64_t acc_[4];
+    std::uint64_t seed_;
+    std::uint64_t totalLength_;
+    std::array<std::byte, 32> buffer_;
+    std::size_t bufferSize_;
+};
+
+// XXH64 of a file's content, read in chunks so large files are not held in
+// memory; also reports the file size
+std::uint64_t computeFileXXH64(const std::filesystem::path& path, std::int64_t& outSize);
+
 // Content hash for file deduplication
 std::string computeContentHash(std::span<const std::byte> data);
 
@@ -0,0 +1,58 @@
+#include "util/IOBackend.h"
+#include <cerrno>
+#include <stdexcept>
+
+namespace rdx::core {
+
+namespace {
+
+// Executes every request synchronously at submit time
+class PositionalIOBackend : public IOBackend {
+public:
+    explicit PositionalIOBackend(FileHandle& file) : file_(file) {}
+    
+    const char* name() const override { return "positional"; }
+    
+    void submit(std::span<const IORequest> requests) override {
+        for (const IORequest& request : requests) {
+            IOCompletion completion;
+            completion.userData = request.userData;
+            try {
+                if (request.kind == IORequest::Kind::Read) {
+                    file_.readAt(request.offset, request.buffer, request.length);
+                } else {
+                    file_.writeAt(request.offset, request.buffer, request.length);
+                }
+            } catch (const std::exception&) {
+                completion.error = EIO;
+            }
+            completed_.push_back(completion);
+        }
+    }
+    
+    void waitCompletions(std::vector<IOCompletion>& out, std::size_t) override {
+        out.insert(out.end(), completed_.begin(), completed_.end());
+        completed_.clear();
+    }
+    
+    std::size_t pending() const override { return completed_.size(); }
+
+private:
+    FileHandle& file_;
+    std::vector<IOCompletion> completed_;
+};
+
+} // namespace
+
+std::unique_ptr<IOBackend> createIOBackend(FileHandle& file, IOBackendKind kind, unsigned queueDepth) {
+#ifdef RDX_HAVE_IO_URING
+    if (kind != IOBackendKind::Positional) {
+        if (auto backend = createIoUringBackend(file, queueDepth)) {
+            return backend;
+        }
+    }
+#endif
+    return std::make_unique<PositionalIOBackend>(file);
+}
+
+} // namespace rdx::core
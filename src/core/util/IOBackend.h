@@ -0,0 +1,72 @@
+#ifndef RDX_IOBACKEND_H
+#define RDX_IOBACKEND_H
+
+#include "util/FileHandle.h"
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace rdx::core {
+
+struct IORequest {
+    enum class Kind { Read, Write };
+    
+    Kind kind = Kind::Read;
+    std::int64_t offset = 0;
+    std::byte* buffer = nullptr;   // Source for writes, destination for reads
+    std::size_t length = 0;
+    int registeredBuffer = -1;     // Index from registerBuffers(), or -1
+    std::uint64_t userData = 0;    // Returned unchanged in the completion
+};
+
+struct IOCompletion {
+    std::uint64_t userData = 0;
+    int error = 0;                 // 0 on success, otherwise an errno value
+};
+
+enum class IOBackendKind {
+    Auto,        // io_uring where available, positional I/O otherwise
+    IoUring,     // Linux io_uring; falls back to Positional if unavailable
+    Positional   // Blocking pread/pwrite (ReadFile/WriteFile on Windows)
+};
+
+// Batched asynchronous I/O against a single open file. Requests always
+// transfer their full length (short transfers are resumed internally) and
+// finish in any order; callers match completions by userData.
+// An IOBackend is not thread-safe; use one per thread.
+class IOBackend {
+public:
+    virtual ~IOBackend() = default;
+    
+    virtual const char* name() const = 0;
+    
+    // Pins buffers for zero-copy fixed I/O. Returns false if the backend
+    // cannot register them, in which case requests must use -1.
+    virtual bool registerBuffers(std::span<const std::span<std::byte>>) { return false; }
+    
+    // Hands a batch of requests to the kernel with as few syscalls as possible
+    virtual void submit(std::span<const IORequest> requests) = 0;
+    
+    // Blocks until at least `minCompletions` requests (bounded by pending())
+    // have finished and appends their completions to `out`
+    virtual void waitCompletions(std::vector<IOCompletion>& out, std::size_t minCompletions) = 0;
+    
+    // Requests submitted but not yet returned from waitCompletions
+    virtual std::size_t pending() const = 0;
+};
+
+// The file must outlive the backend. `queueDepth` bounds requests in flight.
+std::unique_ptr<IOBackend> createIOBackend(FileHandle& file,
+                                           IOBackendKind kind = IOBackendKind::Auto,
+                                           unsigned queueDepth = 64);
+
+#ifdef RDX_HAVE_IO_URING
+// Returns nullptr if io_uring is unsupported or blocked (old kernel, seccomp)
+std::unique_ptr<IOBackend> createIoUringBackend(FileHandle& file, unsigned queueDepth);
+#endif
+
+} // namespace rdx::core
+
+#endif // RDX_IOBACKEND_H
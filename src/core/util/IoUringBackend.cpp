@@ -0,0 +1,329 @@
+#include "util/IOBackend.h"
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Talks to the kernel through the raw io_uring ABI (no liburing dependency).
+// Only plain submit/complete is used: no SQPOLL, no linked requests.
+
+namespace rdx::core {
+
+namespace {
+
+// Largest transfer per SQE; longer requests are resumed like short transfers
+constexpr std::size_t MAX_TRANSFER = std::size_t(1) << 30;
+
+int ioUringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int ioUringRegister(int ringFd, unsigned opcode, const void* arg, unsigned count) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, ringFd, opcode, arg, count));
+}
+
+// Ring indices are shared with the kernel
+unsigned loadAcquire(const unsigned* p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+void storeRelease(unsigned* p, unsigned value) { __atomic_store_n(p, value, __ATOMIC_RELEASE); }
+
+class IoUringBackend : public IOBackend {
+public:
+    explicit IoUringBackend(int fd) : fd_(fd) {}
+    
+    ~IoUringBackend() override {
+        // The kernel may still be reading from or writing into caller buffers
+        if (pending() > 0) {
+            try {
+                std::vector<IOCompletion> discarded;
+                waitCompletions(discarded, pending());
+            } catch (...) {
+            }
+        }
+        
+        if (sqes_) {
+            ::munmap(sqes_, sqesSize_);
+        }
+        if (cqRing_ && cqRing_ != sqRing_) {
+            ::munmap(cqRing_, cqRingSize_);
+        }
+        if (sqRing_) {
+            ::munmap(sqRing_, sqRingSize_);
+        }
+        if (ringFd_ >= 0) {
+            ::close(ringFd_);
+        }
+    }
+    
+    // Returns false if the ring cannot be set up or lacks IORING_OP_READ/WRITE (< 5.6)
+    bool open(unsigned queueDepth) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ringFd_ = ioUringSetup(std::max(queueDepth, 1u), &params);
+        if (ringFd_ < 0) {
+            return false;
+        }
+        
+        sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap) {
+            sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+        }
+        
+        void* sq = ::mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ringFd_, IORING_OFF_SQ_RING);
+        if (sq == MAP_FAILED) {
+            return false;
+        }
+        sqRing_ = static_cast<std::byte*>(sq);
+        
+        if (singleMap) {
+            cqRing_ = sqRing_;
+        } else {
+            void* cq = ::mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              ringFd_, IORING_OFF_CQ_RING);
+            if (cq == MAP_FAILED) {
+                return false;
+            }
+            cqRing_ = static_cast<std::byte*>(cq);
+        }
+        
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ringFd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            return false;
+        }
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+        
+        sqHead_ = reinterpret_cast<unsigned*>(sqRing_ + params.sq_off.head);
+        sqTail_ = reinterpret_cast<unsigned*>(sqRing_ + params.sq_off.tail);
+        sqMask_ = *reinterpret_cast<unsigned*>(sqRing_ + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sqRing_ + params.sq_off.array);
+        cqHead_ = reinterpret_cast<unsigned*>(cqRing_ + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cqRing_ + params.cq_off.tail);
+        cqMask_ = *reinterpret_cast<unsigned*>(cqRing_ + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cqRing_ + params.cq_off.cqes);
+        
+        // In-flight requests never exceed the SQ size, so the CQ cannot overflow
+        capacity_ = params.sq_entries;
+        slots_.resize(capacity_);
+        for (unsigned i = capacity_; i > 0; --i) {
+            freeSlots_.push_back(i - 1);
+        }
+        
+        return supportsReadWrite();
+    }
+    
+    const char* name() const override { return "io_uring"; }
+    
+    bool registerBuffers(std::span<const std::span<std::byte>> buffers) override {
+        if (buffersRegistered_) {
+            ioUringRegister(ringFd_, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+            buffersRegistered_ = false;
+        }
+        
+        std::vector<iovec> iovecs;
+        iovecs.reserve(buffers.size());
+        for (const auto& buffer : buffers) {
+            iovecs.push_back({buffer.data(), buffer.size()});
+        }
+        
+        // Typically fails only when RLIMIT_MEMLOCK is too small
+        buffersRegistered_ = ioUringRegister(ringFd_, IORING_REGISTER_BUFFERS, iovecs.data(),
+                                             static_cast<unsigned>(iovecs.size())) == 0;
+        return buffersRegistered_;
+    }
+    
+    void submit(std::span<const IORequest> requests) override {
+        for (const IORequest& request : requests) {
+            while (freeSlots_.empty()) {
+                flush();
+                reap(1);
+            }
+            
+            unsigned slot = freeSlots_.back();
+            freeSlots_.pop_back();
+            slots_[slot] = {request, 0};
+            if (!buffersRegistered_) {
+                slots_[slot].request.registeredBuffer = -1;
+            }
+            queue(slot);
+        }
+        flush();
+    }
+    
+    void waitCompletions(std::vector<IOCompletion>& out, std::size_t minCompletions) override {
+        std::size_t target = std::min(minCompletions, pending());
+        
+        reap(0);
+        while (ready_.size() < target) {
+            reap(static_cast<unsigned>(target - ready_.size()));
+        }
+        
+        out.insert(out.end(), ready_.begin(), ready_.end());
+        ready_.clear();
+    }
+    
+    std::size_t pending() const override {
+        return (capacity_ - freeSlots_.size()) + ready_.size();
+    }
+
+private:
+    struct Slot {
+        IORequest request;
+        std::size_t done;   // Bytes transferred so far
+    };
+    
+    int fd_;
+    int ringFd_ = -1;
+    
+    std::byte* sqRing_ = nullptr;
+    std::byte* cqRing_ = nullptr;
+    io_uring_sqe* sqes_ = nullptr;
+    std::size_t sqRingSize_ = 0;
+    std::size_t cqRingSize_ = 0;
+    std::size_t sqesSize_ = 0;
+    
+    unsigned* sqHead_ = nullptr;
+    unsigned* sqTail_ = nullptr;
+    unsigned* sqArray_ = nullptr;
+    unsigned sqMask_ = 0;
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned cqMask_ = 0;
+    
+    unsigned capacity_ = 0;
+    unsigned unsubmitted_ = 0;
+    bool buffersRegistered_ = false;
+    std::vector<Slot> slots_;
+    std::vector<unsigned> freeSlots_;
+    std::vector<IOCompletion> ready_;
+    
+    bool supportsReadWrite() {
+        std::vector<std::byte> storage(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op));
+        auto* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+        if (ioUringRegister(ringFd_, IORING_REGISTER_PROBE, probe, 256) < 0) {
+            return false;
+        }
+        auto supported = [&](unsigned op) {
+            return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+        };
+        return supported(IORING_OP_READ) && supported(IORING_OP_WRITE) &&
+               supported(IORING_OP_READ_FIXED) && supported(IORING_OP_WRITE_FIXED);
+    }
+    
+    // Places the remaining part of a slot's request in the submission queue
+    void queue(unsigned slot) {
+        const Slot& s = slots_[slot];
+        bool read = s.request.kind == IORequest::Kind::Read;
+        bool fixed = s.request.registeredBuffer >= 0;
+        
+        unsigned tail = *sqTail_;
+        unsigned index = tail & sqMask_;
+        io_uring_sqe* sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = read ? (fixed ? IORING_OP_READ_FIXED : IORING_OP_READ)
+                           : (fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE);
+        sqe->fd = fd_;
+        sqe->off = static_cast<std::uint64_t>(s.request.offset) + s.done;
+        sqe->addr = reinterpret_cast<std::uint64_t>(s.request.buffer + s.done);
+        sqe->len = static_cast<unsigned>(std::min(s.request.length - s.done, MAX_TRANSFER));
+        if (fixed) {
+            sqe->buf_index = static_cast<std::uint16_t>(s.request.registeredBuffer);
+        }
+        sqe->user_data = slot;
+        
+        sqArray_[index] = index;
+        storeRelease(sqTail_, tail + 1);
+        ++unsubmitted_;
+    }
+    
+    void flush() {
+        while (unsubmitted_ > 0) {
+            int submitted = ioUringEnter(ringFd_, unsubmitted_, 0, 0);
+            if (submitted < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EBUSY) {
+                    reap(1);
+                    continue;
+                }
+                throw std::runtime_error(std::string("io_uring submit failed: ") + std::strerror(errno));
+            }
+            unsubmitted_ -= static_cast<unsigned>(submitted);
+        }
+    }
+    
+    // Waits for `minComplete` CQEs (0 = just collect what is there) and
+    // turns finished slots into completions
+    void reap(unsigned minComplete) {
+        if (minComplete > 0 && loadAcquire(cqTail_) == *cqHead_) {
+            while (ioUringEnter(ringFd_, 0, minComplete, IORING_ENTER_GETEVENTS) < 0) {
+                if (errno != EINTR && errno != EAGAIN) {
+                    throw std::runtime_error(std::string("io_uring wait failed: ") + std::strerror(errno));
+                }
+            }
+        }
+        
+        unsigned head = *cqHead_;
+        unsigned tail = loadAcquire(cqTail_);
+        bool requeued = false;
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = cqes_[head & cqMask_];
+            unsigned slot = static_cast<unsigned>(cqe.user_data);
+            Slot& s = slots_[slot];
+            
+            int error = 0;
+            if (cqe.res == -EAGAIN || cqe.res == -EINTR) {
+                queue(slot);
+                requeued = true;
+                continue;
+            } else if (cqe.res < 0) {
+                error = -cqe.res;
+            } else if (cqe.res == 0) {
+                error = EIO;   // Unexpected end of file
+            } else {
+                s.done += static_cast<std::size_t>(cqe.res);
+                if (s.done < s.request.length) {
+                    queue(slot);
+                    requeued = true;
+                    continue;
+                }
+            }
+            
+            ready_.push_back({s.request.userData, error});
+            freeSlots_.push_back(slot);
+        }
+        storeRelease(cqHead_, head);
+        
+        if (requeued) {
+            flush();
+        }
+    }
+};
+
+} // namespace
+
+std::unique_ptr<IOBackend> createIoUringBackend(FileHandle& file, unsigned queueDepth) {
+    auto backend = std::make_unique<IoUringBackend>(file.descriptor());
+    if (!backend->open(queueDepth)) {
+        return nullptr;
+    }
+    return backend;
+}
+
+} // namespace rdx::core
@@ -0,0 +1,92 @@
+#include "util/MappedFile.h"
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rdx::core {
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Failed to open file for mapping: " + path.string());
+    }
+    fileHandle_ = file;
+    
+    LARGE_INTEGER li;
+    if (!GetFileSizeEx(file, &li)) {
+        CloseHandle(file);
+        throw std::runtime_error("Failed to query file size: " + path.string());
+    }
+    size_ = static_cast<std::size_t>(li.QuadPart);
+    if (size_ == 0) {
+        return;
+    }
+    
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        throw std::runtime_error("Failed to map file: " + path.string());
+    }
+    mappingHandle_ = mapping;
+    
+    data_ = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!data_) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        throw std::runtime_error("Failed to map file: " + path.string());
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file for mapping: " + path.string());
+    }
+    
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to query file size: " + path.string());
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ == 0) {
+        ::close(fd);
+        return;
+    }
+    
+    void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);  // The mapping keeps its own reference to the file
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("Failed to map file: " + path.string());
+    }
+    data_ = static_cast<const std::byte*>(addr);
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+    if (data_) {
+        UnmapViewOfFile(data_);
+    }
+    if (mappingHandle_) {
+        CloseHandle(static_cast<HANDLE>(mappingHandle_));
+    }
+    if (fileHandle_) {
+        CloseHandle(static_cast<HANDLE>(fileHandle_));
+    }
+#else
+    if (data_) {
+        ::munmap(const_cast<std::byte*>(data_), size_);
+    }
+#endif
+}
+
+} // namespace rdx::core
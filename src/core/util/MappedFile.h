@@ -0,0 +1,35 @@
+#ifndef RDX_MAPPEDFILE_H
+#define RDX_MAPPEDFILE_H
+
+#include <filesystem>
+#include <span>
+#include <cstddef>
+
+namespace rdx::core {
+
+// Read-only memory mapping of a whole file. The mapping is immutable, so
+// any number of threads may read from data() concurrently.
+class MappedFile {
+public:
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+    
+    // Disable copy
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    std::span<const std::byte> data() const { return {data_, size_}; }
+    std::size_t size() const { return size_; }
+
+private:
+    const std::byte* data_ = nullptr;
+    std::size_t size_ = 0;
+#ifdef _WIN32
+    void* fileHandle_ = nullptr;
+    void* mappingHandle_ = nullptr;
+#endif
+};
+
+} // namespace rdx::core
+
+#endif // RDX_MAPPEDFILE_H
@@ -0,0 +1,87 @@
+#include "util/ParallelFor.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rdx::core {
+
+namespace {
+
+// Set while the thread runs items of a multi-threaded parallelFor
+thread_local bool onParallelWorker = false;
+
+} // namespace
+
+unsigned resolveThreadCount(unsigned requested) {
+    if (requested > 0) {
+        return requested;
+    }
+    if (onParallelWorker) {
+        return 1;
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void parallelFor(std::size_t count, unsigned threadCount,
+                 const std::function<void(std::size_t)>& fn) {
+    if (count == 0) {
+        return;
+    }
+    
+    std::size_t workers = std::min<std::size_t>(resolveThreadCount(threadCount), count);
+    if (workers == 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+    
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr firstError;
+    std::mutex errorMutex;
+    
+    auto runItems = [&]() {
+        while (!failed.load(std::memory_order_relaxed)) {
+            std::size_t i = next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= count) {
+                return;
+            }
+            try {
+                fn(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!firstError) {
+                    firstError = std::current_exception();
+                }
+                failed.store(true, std::memory_order_relaxed);
+            }
+        }
+    };
+    
+    auto worker = [&]() {
+        bool wasOnWorker = onParallelWorker;
+        onParallelWorker = true;
+        runItems();
+        onParallelWorker = wasOnWorker;
+    };
+    
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (std::size_t t = 1; t < workers; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    if (firstError) {
+        std::rethrow_exception(firstError);
+    }
+}
+
+} // namespace rdx::core
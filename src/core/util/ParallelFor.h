@@ -0,0 +1,22 @@
+#ifndef RDX_PARALLELFOR_H
+#define RDX_PARALLELFOR_H
+
+#include <cstddef>
+#include <functional>
+
+namespace rdx::core {
+
+// Number of worker threads to use; 0 means one per hardware thread, or one
+// when called from a parallelFor worker, so nested loops share the outer
+// loop's threads instead of multiplying them
+unsigned resolveThreadCount(unsigned requested);
+
+// Runs fn(i) for every i in [0, count) on up to `threadCount` threads.
+// Items are handed out dynamically, so uneven work balances itself.
+// The first exception thrown by fn is rethrown once all workers have stopped.
+void parallelFor(std::size_t count, unsigned threadCount,
+                 const std::function<void(std::size_t)>& fn);
+
+} // namespace rdx::core
+
+#endif // RDX_PARALLELFOR_H
@@ -0,0 +1,188 @@
+#include "util/ZeroExtents.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace rdx::core {
+
+namespace {
+
+bool isAllZero(const std::byte* data, std::size_t size) {
+    // Zero first byte, and every byte equal to its successor
+    return size == 0 || (data[0] == std::byte{0} && std::memcmp(data, data + 1, size - 1) == 0);
+}
+
+// Calls fn(logicalOffset, packedOffset, length) for every stored data segment
+template <typename Fn>
+void forEachSegment(const std::vector<ZeroExtent>& extents, std::int64_t originalSize, Fn&& fn) {
+    std::int64_t logical = 0;
+    std::int64_t packed = 0;
+    for (const ZeroExtent& extent : extents) {
+        if (extent.offset > logical) {
+            fn(logical, packed, extent.offset - logical);
+            packed += extent.offset - logical;
+        }
+        logical = extent.offset + extent.length;
+    }
+    if (originalSize > logical) {
+        fn(logical, packed, originalSize - logical);
+    }
+}
+
+} // namespace
+
+std::vector<ZeroExtent> findZeroExtents(std::span<const std::byte> data,
+                                        std::size_t blockSize,
+                                        std::size_t minLength) {
+    std::vector<ZeroExtent> extents;
+    
+    std::size_t runStart = 0;
+    std::size_t runLength = 0;
+    auto closeRun = [&] {
+        if (runLength >= minLength) {
+            extents.push_back({static_cast<std::int64_t>(runStart), static_cast<std::int64_t>(runLength)});
+        }
+        runLength = 0;
+    };
+    
+    for (std::size_t offset = 0; offset < data.size(); offset += blockSize) {
+        std::size_t length = std::min(blockSize, data.size() - offset);
+        if (isAllZero(data.data() + offset, length)) {
+            if (runLength == 0) {
+                runStart = offset;
+            }
+            runLength += length;
+        } else {
+            closeRun();
+        }
+    }
+    closeRun();
+    
+    return extents;
+}
+
+std::int64_t totalZeroBytes(const std::vector<ZeroExtent>& extents) {
+    std::int64_t total = 0;
+    for (const ZeroExtent& extent : extents) {
+        total += extent.length;
+    }
+    return total;
+}
+
+void validateZeroExtents(const std::vector<ZeroExtent>& extents, std::int64_t size) {
+    std::int64_t end = 0;
+    for (const ZeroExtent& extent : extents) {
+        if (extent.offset < end || extent.length <= 0 || extent.length > size - extent.offset) {
+            throw std::runtime_error("Invalid zero extent");
+        }
+        end = extent.offset + extent.length;
+    }
+}
+
+void removeZeroExtents(std::span<const std::byte> data,
+                       const std::vector<ZeroExtent>& extents,
+                       ByteBuffer& out) {
+    out.clear();
+    out.reserve(data.size() - static_cast<std::size_t>(totalZeroBytes(extents)));
+    forEachSegment(extents, static_cast<std::int64_t>(data.size()),
+                   [&](std::int64_t logical, std::int64_t, std::int64_t length) {
+        out.append(data.subspan(static_cast<std::size_t>(logical), static_cast<std::size_t>(length)));
+    });
+}
+
+void restoreZeroExtents(ByteBuffer& buffer,
+                        const std::vector<ZeroExtent>& extents,
+                        std::int64_t originalSize) {
+    if (extents.empty()) {
+        return;
+    }
+    
+    std::vector<std::int64_t> segments;  // (logical, packed, length) triples
+    forEachSegment(extents, originalSize, [&](std::int64_t logical, std::int64_t packed, std::int64_t length) {
+        segments.insert(segments.end(), {logical, packed, length});
+    });
+    
+    buffer.resize(static_cast<std::size_t>(originalSize));
+    std::byte* data = buffer.mutableDataPtr();
+    
+    // Segments only ever move towards the end, so walking backwards never
+    // overwrites packed bytes that are still to be moved
+    std::int64_t zeroEnd = originalSize;
+    for (std::size_t i = segments.size(); i >= 3; i -= 3) {
+        std::int64_t logical = segments[i - 3];
+        std::int64_t packed = segments[i - 2];
+        std::int64_t length = segments[i - 1];
+        std::int64_t segmentEnd = logical + length;
+        
+        std::memset(data + segmentEnd, 0, static_cast<std::size_t>(zeroEnd - segmentEnd));
+        if (logical != packed) {
+            std::memmove(data + logical, data + packed, static_cast<std::size_t>(length));
+        }
+        zeroEnd = logical;
+    }
+    std::memset(data, 0, static_cast<std::size_t>(zeroEnd));
+}
+
+void writeWithHoles(FileHandle& file,
+                    std::span<const std::byte> packed,
+                    const std::vector<ZeroExtent>& extents,
+                    std::int64_t originalSize) {
+    if (!extents.empty()) {
+        file.markSparse();
+    }
+    
+    forEachSegment(extents, originalSize, [&](std::int64_t logical, std::int64_t packedOffset, std::int64_t length) {
+        file.writeAt(logical, packed.data() + packedOffset, static_cast<std::size_t>(length));
+    });
+    
+    // Extending past the last write leaves a trailing hole
+    if (file.size() != originalSize) {
+        file.resize(originalSize);
+    }
+}
+
+PackedContentCursor::PackedContentCursor(const std::vector<ZeroExtent>& extents,
+                                         std::int64_t originalSize,
+                                         std::int64_t packedStart)
+    : extents_(extents)
+    , originalSize_(originalSize) {
+    skipExtents();
+    
+    // Walk the stored segments up to the start position
+    while (packedStart > 0) {
+        std::int64_t segmentEnd = nextExtent_ < extents_.size() ? extents_[nextExtent_].offset : originalSize_;
+        std::int64_t step = std::min(packedStart, segmentEnd - logical_);
+        if (step <= 0) {
+            throw std::runtime_error("Packed content exceeds entry size");
+        }
+        logical_ += step;
+        packedStart -= step;
+        skipExtents();
+    }
+}
+
+void PackedContentCursor::skipExtents() {
+    while (nextExtent_ < extents_.size() && extents_[nextExtent_].offset == logical_) {
+        logical_ += extents_[nextExtent_].length;
+        ++nextExtent_;
+    }
+}
+
+void PackedContentCursor::advance(std::span<const std::byte> chunk,
+                                  const std::function<void(std::int64_t, std::span<const std::byte>)>& fn) {
+    while (!chunk.empty()) {
+        std::int64_t segmentEnd = nextExtent_ < extents_.size() ? extents_[nextExtent_].offset : originalSize_;
+        std::int64_t available = segmentEnd - logical_;
+        if (available <= 0) {
+            throw std::runtime_error("Packed content exceeds entry size");
+        }
+        
+        std::size_t length = static_cast<std::size_t>(std::min<std::int64_t>(available, chunk.size()));
+        fn(logical_, chunk.first(length));
+        logical_ += static_cast<std::int64_t>(length);
+        chunk = chunk.subspan(length);
+        skipExtents();
+    }
+}
+
+} // namespace rdx::core
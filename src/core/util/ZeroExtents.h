@@ -0,0 +1,81 @@
+#ifndef RDX_ZEROEXTENTS_H
+#define RDX_ZEROEXTENTS_H
+
+#include "util/ByteBuffer.h"
+#include "util/FileHandle.h"
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace rdx::core {
+
+// A run of zero bytes that is not stored and is restored as a file hole
+struct ZeroExtent {
+    std::int64_t offset;
+    std::int64_t length;
+};
+
+// Zero runs are detected on whole, aligned blocks so holes line up with
+// filesystem blocks; shorter runs are not worth an index record
+constexpr std::size_t ZERO_EXTENT_BLOCK_SIZE = 4096;
+constexpr std::size_t ZERO_EXTENT_MIN_LENGTH = 64 * 1024;
+
+// Finds sorted, non-overlapping zero runs of at least `minLength` bytes
+std::vector<ZeroExtent> findZeroExtents(std::span<const std::byte> data,
+                                        std::size_t blockSize = ZERO_EXTENT_BLOCK_SIZE,
+                                        std::size_t minLength = ZERO_EXTENT_MIN_LENGTH);
+
+std::int64_t totalZeroBytes(const std::vector<ZeroExtent>& extents);
+
+// Throws unless the extents are sorted, non-overlapping and inside `size`
+void validateZeroExtents(const std::vector<ZeroExtent>& extents, std::int64_t size);
+
+// Copies `data` without the extents ("packed" content)
+void removeZeroExtents(std::span<const std::byte> data,
+                       const std::vector<ZeroExtent>& extents,
+                       ByteBuffer& out);
+
+// Inverse of removeZeroExtents, in place: `buffer` holds the packed content
+// at its start and is resized to `originalSize` with the extents zero-filled
+void restoreZeroExtents(ByteBuffer& buffer,
+                        const std::vector<ZeroExtent>& extents,
+                        std::int64_t originalSize);
+
+// Writes packed content to a freshly truncated file at its original offsets
+// and sets the file size, leaving the extents as holes
+void writeWithHoles(FileHandle& file,
+                    std::span<const std::byte> packed,
+                    const std::vector<ZeroExtent>& extents,
+                    std::int64_t originalSize);
+
+// Places packed content that arrives in pieces, in order, at its original
+// offsets, so streamed output never needs the whole entry in memory
+class PackedContentCursor {
+public:
+    // Starts at packed offset `packedStart`, e.g. the first byte of a frame
+    PackedContentCursor(const std::vector<ZeroExtent>& extents,
+                        std::int64_t originalSize,
+                        std::int64_t packedStart = 0);
+    
+    // Calls fn(logicalOffset, bytes) for each stored segment `chunk` covers.
+    // Throws if the packed content runs past the entry.
+    void advance(std::span<const std::byte> chunk,
+                 const std::function<void(std::int64_t, std::span<const std::byte>)>& fn);
+    
+    // Logical offset of the next packed byte (originalSize once complete)
+    std::int64_t position() const { return logical_; }
+
+private:
+    const std::vector<ZeroExtent>& extents_;
+    std::int64_t originalSize_;
+    std::size_t nextExtent_ = 0;
+    std::int64_t logical_ = 0;
+    
+    void skipExtents();
+};
+
+} // namespace rdx::core
+
+#endif // RDX_ZEROEXTENTS_H
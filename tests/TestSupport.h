@@ -0,0 +1,205 @@
+#ifndef RDX_TESTSUPPORT_H
+#define RDX_TESTSUPPORT_H
+
+// Shared helpers for the test executables. Tests are written against the
+// GoogleTest macros; when GTest is not available (RDX_SIMPLE_TEST, see
+// tests/CMakeLists.txt) a minimal stand-in for the macros used is provided.
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#ifndef RDX_SIMPLE_TEST
+#include <gtest/gtest.h>
+#else
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace rdx::test {
+
+struct TestCase {
+    const char* suite;
+    const char* name;
+    void (*run)();
+};
+
+inline std::vector<TestCase>& testCases() {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+inline int& currentFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+struct TestRegistrar {
+    TestRegistrar(const char* suite, const char* name, void (*run)()) {
+        testCases().push_back({suite, name, run});
+    }
+};
+
+// Thrown by a failed ASSERT_* to leave the test body
+struct FatalFailure {};
+
+inline void reportFailure(const char* file, int line, const std::string& what) {
+    std::cerr << file << ":" << line << ": Failure: " << what << "\n";
+    ++currentFailures();
+}
+
+} // namespace rdx::test
+
+#define TEST(suite, name)                                                             \
+    static void suite##_##name##_Test();                                              \
+    static ::rdx::test::TestRegistrar suite##_##name##_registrar(#suite, #name,       \
+                                                                 &suite##_##name##_Test); \
+    static void suite##_##name##_Test()
+
+#define RDX_TEST_CHECK(condition, text, fatal)                                        \
+    do {                                                                              \
+        if (!(condition)) {                                                           \
+            ::rdx::test::reportFailure(__FILE__, __LINE__, text);                     \
+            if (fatal) {                                                              \
+                throw ::rdx::test::FatalFailure{};                                    \
+            }                                                                         \
+        }                                                                             \
+    } while (0)
+
+#define EXPECT_TRUE(c) RDX_TEST_CHECK((c), #c, false)
+#define EXPECT_FALSE(c) RDX_TEST_CHECK(!(c), "!(" #c ")", false)
+#define EXPECT_EQ(a, b) RDX_TEST_CHECK((a) == (b), #a " == " #b, false)
+#define EXPECT_NE(a, b) RDX_TEST_CHECK((a) != (b), #a " != " #b, false)
+#define EXPECT_LT(a, b) RDX_TEST_CHECK((a) < (b), #a " < " #b, false)
+#define EXPECT_LE(a, b) RDX_TEST_CHECK((a) <= (b), #a " <= " #b, false)
+#define EXPECT_GT(a, b) RDX_TEST_CHECK((a) > (b), #a " > " #b, false)
+#define EXPECT_GE(a, b) RDX_TEST_CHECK((a) >= (b), #a " >= " #b, false)
+#define ASSERT_TRUE(c) RDX_TEST_CHECK((c), #c, true)
+#define ASSERT_FALSE(c) RDX_TEST_CHECK(!(c), "!(" #c ")", true)
+#define ASSERT_EQ(a, b) RDX_TEST_CHECK((a) == (b), #a " == " #b, true)
+#define ASSERT_NE(a, b) RDX_TEST_CHECK((a) != (b), #a " != " #b, true)
+#define ASSERT_GE(a, b) RDX_TEST_CHECK((a) >= (b), #a " >= " #b, true)
+
+#define EXPECT_THROW(statement, exceptionType)                                        \
+    do {                                                                              \
+        bool rdxCaught = false;                                                       \
+        try {                                                                         \
+            statement;                                                                \
+        } catch (const exceptionType&) {                                              \
+            rdxCaught = true;                                                         \
+        } catch (...) {                                                               \
+        }                                                                             \
+        RDX_TEST_CHECK(rdxCaught, #statement " throws " #exceptionType, false);       \
+    } while (0)
+
+#define EXPECT_NO_THROW(statement)                                                    \
+    do {                                                                              \
+        try {                                                                         \
+            statement;                                                                \
+        } catch (...) {                                                               \
+            RDX_TEST_CHECK(false, #statement " does not throw", false);               \
+        }                                                                             \
+    } while (0)
+
+int main() {
+    int failedTests = 0;
+    for (const auto& test : ::rdx::test::testCases()) {
+        std::cout << "[ RUN      ] " << test.suite << "." << test.name << std::endl;
+        ::rdx::test::currentFailures() = 0;
+        try {
+            test.run();
+        } catch (const ::rdx::test::FatalFailure&) {
+        } catch (const std::exception& e) {
+            ::rdx::test::reportFailure(__FILE__, __LINE__,
+                                       std::string("unexpected exception: ") + e.what());
+        }
+        bool passed = ::rdx::test::currentFailures() == 0;
+        failedTests += passed ? 0 : 1;
+        std::cout << (passed ? "[       OK ] " : "[  FAILED  ] ")
+                  << test.suite << "." << test.name << std::endl;
+    }
+    std::cout << ::rdx::test::testCases().size() - failedTests << " of "
+              << ::rdx::test::testCases().size() << " tests passed" << std::endl;
+    return failedTests == 0 ? 0 : 1;
+}
+#endif // RDX_SIMPLE_TEST
+
+namespace rdx::test {
+
+// Directory below the system temp directory, removed with its contents
+class TempDir {
+public:
+    TempDir() {
+        auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+        auto base = std::filesystem::temp_directory_path();
+        for (unsigned attempt = 0;; ++attempt) {
+            path_ = base / ("rdx-test-" + std::to_string(stamp) + "-" + std::to_string(attempt));
+            if (std::filesystem::create_directory(path_)) {
+                break;
+            }
+        }
+    }
+    
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path_, ec);
+    }
+    
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+    
+    const std::filesystem::path& path() const { return path_; }
+    std::filesystem::path operator/(const std::string& name) const { return path_ / name; }
+
+private:
+    std::filesystem::path path_;
+};
+
+inline void writeFile(const std::filesystem::path& path, std::string_view content) {
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path());
+    }
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(content.data(), static_cast<std::streamsize>(content.size()));
+}
+
+inline std::string readFile(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+// Deterministic, poorly compressible bytes; no zero bytes, so nothing is
+// stored as a zero extent unless a test asks for it
+inline std::string randomContent(std::size_t size, std::uint64_t seed) {
+    std::string content(size, '\0');
+    std::uint64_t state = seed * 0x9E3779B97F4A7C15ULL + 1;
+    for (auto& c : content) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        c = static_cast<char>(1 + state % 255);
+    }
+    return content;
+}
+
+// Compressible text of roughly `size` bytes
+inline std::string textContent(std::size_t size, unsigned seed) {
+    std::string content;
+    for (unsigned line = 0; content.size() < size; ++line) {
+        content += "2024-01-01 12:00:" + std::to_string(line % 60) + " INFO worker-" +
+                   std::to_string((line + seed) % 8) + " processed request " +
+                   std::to_string(line * 7 + seed) + "\n";
+    }
+    content.resize(size);
+    return content;
+}
+
+} // namespace rdx::test
+
+#endif // RDX_TESTSUPPORT_H
@@ -0,0 +1,743 @@
+#include "TestSupport.h"
+#include "lcm/LCMManager.h"
+#include "lcm/LCMWriteQueue.h"
+#include "util/HashUtils.h"
+#include "util/TimeUtils.h"
+#include <sqlite3.h>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace rdx::core;
+using rdx::test::TempDir;
+
+namespace {
+
+std::string hashOf(const std::string& text) {
+    return computeContentHash(std::span<const std::byte>(
+        reinterpret_cast<const std::byte*>(text.data()), text.size()));
+}
+
+FileInfo makeFile(const std::string& name, std::int64_t size, int fileTypeId, int schemaId) {
+    FileInfo info{};
+    info.contentHash = hashOf("content:" + name);
+    info.pathHash = hashOf("path:" + name);
+    info.sizeBytes = size;
+    info.fileTypeId = fileTypeId;
+    info.schemaId = schemaId;
+    info.firstSeenAt = 1000;
+    info.lastSeenAt = 1000;
+    return info;
+}
+
+} // namespace
+
+TEST(LCMManager, RegistersAndFindsFiles) {
+    TempDir dir;
+    LCMManager lcm(dir / "lcm.db");
+    int typeId = lcm.getOrCreateFileTypeId("text", "txt");
+    int schemaId = lcm.getOrCreateSchemaId("log", 1, "{}");
+    
+    FileInfo info = makeFile("a", 1234, typeId, schemaId);
+    int fileId = lcm.registerFile(info);
+    EXPECT_GT(fileId, 0);
+    
+    auto found = lcm.findFileByContentHash(info.contentHash);
+    ASSERT_TRUE(found.has_value());
+    EXPECT_EQ(found->contentHash, info.contentHash);
+    EXPECT_EQ(found->pathHash, info.pathHash);
+    EXPECT_EQ(found->sizeBytes, 1234);
+    EXPECT_EQ(found->fileTypeId, typeId);
+    EXPECT_FALSE(lcm.findFileByContentHash(hashOf("unknown")).has_value());
+}
+
+TEST(LCMManager, FileTypeAndSchemaIdsAreStable) {
+    TempDir dir;
+    int typeId = 0;
+    int schemaId = 0;
+    {
+        LCMManager lcm(dir / "lcm.db");
+        typeId = lcm.getOrCreateFileTypeId("text", "txt");
+        schemaId = lcm.getOrCreateSchemaId("log", 1, "{\"fields\":[]}");
+        EXPECT_EQ(lcm.getOrCreateFileTypeId("text", "txt"), typeId);
+        EXPECT_EQ(lcm.getOrCreateSchemaId("log", 1, "{\"fields\":[]}"), schemaId);
+        EXPECT_NE(lcm.getOrCreateSchemaId("log", 2, "{}"), schemaId);
+    }
+    LCMManager reopened(dir / "lcm.db");
+    EXPECT_EQ(reopened.getOrCreateFileTypeId("text", "txt"), typeId);
+    EXPECT_EQ(reopened.getFileTypeName(typeId), "text");
+    auto definition = reopened.loadSchemaDefinition(schemaId);
+    ASSERT_TRUE(definition.has_value());
+    EXPECT_EQ(*definition, "{\"fields\":[]}");
+}
+
+TEST(LCMManager, DurabilityProfilesConfigureEveryConnection) {
+    TempDir dir;
+    struct Expected {
+        LCMDurability durability;
+        int synchronous;
+        std::int64_t cacheKiB;
+        std::int64_t mmapSize;
+        int tempStore;
+    };
+    const Expected profiles[] = {
+        {LCMDurability::Safe, 2, 2 * 1024, 0, 0},
+        {LCMDurability::Balanced, 1, 32 * 1024, std::int64_t(256) << 20, 2},
+        {LCMDurability::Ingest, 0, 256 * 1024, std::int64_t(1) << 30, 2},
+    };
+    
+    auto expectProfile = [](const LCMManager& lcm, const Expected& expected) {
+        LCMConnectionSettings writer = lcm.getConnectionSettings();
+        EXPECT_EQ(writer.journalMode, "wal");
+        EXPECT_EQ(writer.synchronous, expected.synchronous);
+        EXPECT_EQ(writer.cacheSize, -expected.cacheKiB);
+        EXPECT_EQ(writer.mmapSize, expected.mmapSize);
+        EXPECT_EQ(writer.tempStore, expected.tempStore);
+        
+        // Readers get a quarter of the writer's cache
+        LCMConnectionSettings reader = lcm.getConnectionSettings(true);
+        EXPECT_EQ(reader.journalMode, "wal");
+        EXPECT_EQ(reader.cacheSize, -expected.cacheKiB / 4);
+        EXPECT_EQ(reader.mmapSize, expected.mmapSize);
+        EXPECT_EQ(reader.tempStore, expected.tempStore);
+    };
+    
+    for (const Expected& expected : profiles) {
+        LCMManager lcm(dir / "lcm.db", expected.durability);
+        EXPECT_TRUE(lcm.getDurability() == expected.durability);
+        expectProfile(lcm, expected);
+    }
+    
+    // Switching profiles reconfigures the writer and replaces the pooled
+    // readers, including idle ones opened under the previous profile
+    LCMManager lcm(dir / "lcm.db", LCMDurability::Safe);
+    expectProfile(lcm, profiles[0]);
+    for (const Expected& expected : {profiles[2], profiles[1], profiles[0]}) {
+        lcm.setDurability(expected.durability);
+        EXPECT_TRUE(lcm.getDurability() == expected.durability);
+        expectProfile(lcm, expected);
+    }
+}
+
+namespace {
+
+FileChunkInfo makeChunk(const std::string& file, std::int64_t offset, int schemaId) {
+    FileChunkInfo chunk{};
+    chunk.offsetBytes = offset;
+    chunk.lengthBytes = 4096;
+    chunk.chunkHash = hashOf("chunk:" + file + ":" + std::to_string(offset));
+    chunk.chunkFingerprint = static_cast<std::uint64_t>(offset) * 31 + file.size();
+    chunk.schemaId = schemaId;
+    chunk.seenCount = 1;
+    return chunk;
+}
+
+LCMWrite makeRegistration(const std::string& name, std::size_t chunkCount, int typeId, int schemaId,
+                          std::int64_t firstOffset = 0) {
+    LCMWrite write;
+    write.kind = LCMWrite::Kind::RegisterFile;
+    write.file = makeFile(name, static_cast<std::int64_t>(chunkCount) * 4096, typeId, schemaId);
+    for (std::size_t i = 0; i < chunkCount; ++i) {
+        write.chunks.push_back(makeChunk(name, firstOffset + static_cast<std::int64_t>(i) * 4096, schemaId));
+    }
+    return write;
+}
+
+// Runs a single-value query on a separate connection
+std::int64_t queryInt(const std::filesystem::path& dbPath, const std::string& sql) {
+    sqlite3* db = nullptr;
+    sqlite3_open(dbPath.string().c_str(), &db);
+    sqlite3_stmt* stmt = nullptr;
+    std::int64_t value = -1;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        value = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return value;
+}
+
+void execSql(const std::filesystem::path& dbPath, const std::string& sql) {
+    sqlite3* db = nullptr;
+    sqlite3_open(dbPath.string().c_str(), &db);
+    sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr);
+    sqlite3_close(db);
+}
+
+} // namespace
+
+TEST(LCMManager, CachesTypesAndSchemasAndFindsOtherWriters) {
+    TempDir dir;
+    auto dbPath = dir / "lcm.db";
+    LCMManager lcm(dbPath);
+    int typeId = lcm.getOrCreateFileTypeId("text", "txt");
+    int schemaId = lcm.getOrCreateSchemaId("log", 1, "{\"v\":1}");
+    
+    // Rows another manager inserts are found on a miss, not duplicated
+    int otherTypeId = 0;
+    int otherSchemaId = 0;
+    {
+        LCMManager other(dbPath);
+        otherTypeId = other.getOrCreateFileTypeId("json", "json");
+        otherSchemaId = other.getOrCreateSchemaId("doc", 2, "{\"v\":2}");
+    }
+    EXPECT_EQ(lcm.getFileTypeName(otherTypeId), "json");
+    EXPECT_EQ(lcm.getOrCreateFileTypeId("json", "json"), otherTypeId);
+    EXPECT_EQ(lcm.getOrCreateSchemaId("doc", 2, "{\"v\":2}"), otherSchemaId);
+    auto otherDefinition = lcm.loadSchemaDefinition(otherSchemaId);
+    ASSERT_TRUE(otherDefinition.has_value());
+    EXPECT_EQ(*otherDefinition, "{\"v\":2}");
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM file_types"), 2);
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM schema_registry"), 2);
+    
+    // Hits are answered from memory: rows removed behind the manager's back
+    // still resolve, and nothing is inserted again
+    execSql(dbPath, "DELETE FROM file_types; DELETE FROM schema_registry");
+    EXPECT_EQ(lcm.getOrCreateFileTypeId("text", "txt"), typeId);
+    EXPECT_EQ(lcm.getFileTypeName(typeId), "text");
+    EXPECT_EQ(lcm.getOrCreateSchemaId("log", 1, "{\"v\":1}"), schemaId);
+    auto definition = lcm.loadSchemaDefinition(schemaId);
+    ASSERT_TRUE(definition.has_value());
+    EXPECT_EQ(*definition, "{\"v\":1}");
+    EXPECT_EQ(lcm.getOrCreateFileTypeId("json", "json"), otherTypeId);
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM file_types"), 0);
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM schema_registry"), 0);
+}
+
+TEST(LCMManager, ReusesPreparedStatementsAcrossCalls) {
+    TempDir dir;
+    LCMManager lcm(dir / "lcm.db");
+    int typeId = lcm.getOrCreateFileTypeId("text", "txt");
+    int schemaId = lcm.getOrCreateSchemaId("log", 1, "{}");
+    int bundleId = lcm.createBundle(hashOf("bundle"), "nightly");
+    
+    // Every hot write path once; a 70-chunk file also needs a tail INSERT
+    auto runHotPaths = [&](const std::string& tag, std::optional<int> bundle) {
+        std::vector<LCMWrite> writes = {makeRegistration("batch-" + tag, 70, typeId, schemaId)};
+        EXPECT_TRUE(lcm.applyWrites(writes).empty());
+        FileInfo info = makeFile("single-" + tag, 4096, typeId, schemaId);
+        info.bundleId = bundle;
+        int fileId = lcm.registerFileWithChunks(info, {makeChunk("single-" + tag, 0, schemaId)});
+        lcm.updateFileLastSeen(fileId, 2000);
+        lcm.incrementSchemaUsage(schemaId);
+        EXPECT_EQ(lcm.getOrCreateFileTypeId("text", "txt"), typeId);
+    };
+    
+    runHotPaths("1", bundleId);
+    std::size_t prepared = lcm.getPreparedStatementCount();
+    EXPECT_GT(prepared, 0u);
+    for (int i = 2; i <= 5; ++i) {
+        runHotPaths(std::to_string(i), std::nullopt);
+        EXPECT_EQ(lcm.getPreparedStatementCount(), prepared);
+    }
+    
+    // Bindings are cleared between uses: the bundle of the first file does
+    // not carry over to the next
+    auto first = lcm.findFileByContentHash(makeFile("single-1", 0, 0, 0).contentHash);
+    auto second = lcm.findFileByContentHash(makeFile("single-2", 0, 0, 0).contentHash);
+    ASSERT_TRUE(first.has_value() && second.has_value());
+    EXPECT_TRUE(first->bundleId == bundleId);
+    EXPECT_FALSE(second->bundleId.has_value());
+    EXPECT_EQ(queryInt(dir / "lcm.db", "SELECT COUNT(*) FROM chunk_index"), 5 * 71);
+    EXPECT_EQ(queryInt(dir / "lcm.db", "SELECT usage_count FROM schema_registry"), 5);
+}
+
+TEST(LCMManager, RecordsEveryChunkWhateverTheStatementSplit) {
+    TempDir dir;
+    LCMManager lcm(dir / "lcm.db");
+    int typeId = lcm.getOrCreateFileTypeId("text", "txt");
+    int schemaId = lcm.getOrCreateSchemaId("log", 1, "{}");
+    
+    // Full 64-row statements and tails of every length class
+    std::vector<std::size_t> counts = {1, 63, 64, 65, 130, 250};
+    std::vector<LCMWrite> writes;
+    std::int64_t total = 0;
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        writes.push_back(makeRegistration("f" + std::to_string(i), counts[i], typeId, schemaId));
+        total += static_cast<std::int64_t>(counts[i]);
+    }
+    lcm.applyWrites(writes);
+    
+    EXPECT_EQ(queryInt(dir / "lcm.db", "SELECT COUNT(*) FROM chunk_index"), total);
+    EXPECT_EQ(queryInt(dir / "lcm.db", "SELECT COUNT(*) FROM chunk_occurrences"), total);
+    EXPECT_EQ(queryInt(dir / "lcm.db", "SELECT COUNT(*) FROM file_index"), static_cast<std::int64_t>(counts.size()));
+    for (const auto& write : writes) {
+        auto found = lcm.findFileByContentHash(write.file.contentHash);
+        ASSERT_TRUE(found.has_value());
+        EXPECT_EQ(lcm.findSimilarChunksByHash(write.chunks.back().chunkHash, 1).size(), 1u);
+    }
+}
+
+TEST(LCMManager, FailedFileIsRolledBackAlone) {
+    TempDir dir;
+    auto dbPath = dir / "lcm.db";
+    LCMManager lcm(dbPath);
+    int typeId = lcm.getOrCreateFileTypeId("text", "txt");
+    int schemaId = lcm.getOrCreateSchemaId("log", 1, "{}");
+    
+    // The second file fails on its 21st chunk, after its first statement
+    constexpr std::int64_t failingOffset = 1000000 + 20 * 4096;
+    execSql(dbPath, "CREATE TRIGGER fail_chunk BEFORE INSERT ON chunk_index WHEN NEW.offset_bytes = " +
+                        std::to_string(failingOffset) + " BEGIN SELECT RAISE(ABORT, 'injected'); END");
+    
+    std::vector<LCMWrite> writes = {
+        makeRegistration("small", 5, typeId, schemaId),
+        makeRegistration("large", 30, typeId, schemaId, 1000000),
+        makeRegistration("after", 15, typeId, schemaId),
+    };
+    for (auto& write : writes) {
+        write.countsSchemaUse = true;
+    }
+    LCMWrite usage;
+    usage.kind = LCMWrite::Kind::IncrementSchemaUsage;
+    usage.schemaId = schemaId;
+    writes.push_back(usage);
+    auto failures = lcm.applyWrites(writes);
+    ASSERT_EQ(failures.size(), 1u);
+    EXPECT_EQ(failures[0].index, 1u);
+    EXPECT_NE(failures[0].error.find("injected"), std::string::npos);
+    
+    // Only the failing file is rolled back
+    EXPECT_TRUE(lcm.findFileByContentHash(writes[0].file.contentHash).has_value());
+    EXPECT_TRUE(lcm.findFileByContentHash(writes[2].file.contentHash).has_value());
+    EXPECT_FALSE(lcm.findFileByContentHash(writes[1].file.contentHash).has_value());
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM chunk_index"), 20);
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM chunk_index WHERE offset_bytes >= 1000000"), 0);
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM chunk_occurrences WHERE offset_bytes >= 1000000"), 0);
+    
+    // Schema use counts the committed files and the standalone increment
+    EXPECT_EQ(queryInt(dbPath, "SELECT usage_count FROM schema_registry"), 3);
+}
+
+TEST(LCMWriteQueue, FailedTransactionLosesOnlyItsOwnWrites) {
+    TempDir dir;
+    auto dbPath = dir / "lcm.db";
+    LCMManager lcm(dbPath);
+    lcm.setChunkBatchSize(10);
+    int typeId = lcm.getOrCreateFileTypeId("text", "txt");
+    int schemaId = lcm.getOrCreateSchemaId("log", 1, "{}");
+    
+    // Ends the whole transaction, not just the statement
+    execSql(dbPath, "CREATE TRIGGER fail_chunk BEFORE INSERT ON chunk_index WHEN NEW.offset_bytes = 1000000"
+                    " BEGIN SELECT RAISE(ROLLBACK, 'injected'); END");
+    
+    // Every file fills a transaction, however the writer groups the queue
+    std::vector<LCMWrite> writes;
+    {
+        LCMWriteQueue queue(lcm, 16);
+        for (int i = 0; i < 8; ++i) {
+            writes.push_back(makeRegistration("f" + std::to_string(i), 10, typeId, schemaId, i == 5 ? 1000000 : 0));
+            writes.back().countsSchemaUse = true;
+            queue.post(writes.back());
+        }
+        EXPECT_THROW(queue.flush(), std::runtime_error);
+        EXPECT_EQ(queue.getFailedWrites(), 1u);
+    }
+    
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_EQ(lcm.findFileByContentHash(writes[i].file.contentHash).has_value(), i != 5);
+    }
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM chunk_index"), 70);
+    EXPECT_EQ(queryInt(dbPath, "SELECT usage_count FROM schema_registry"), 7);
+}
+
+TEST(LCMWriteQueue, ReportsFailedFilesToTheProducer) {
+    TempDir dir;
+    auto dbPath = dir / "lcm.db";
+    LCMManager lcm(dbPath);
+    int typeId = lcm.getOrCreateFileTypeId("text", "txt");
+    int schemaId = lcm.getOrCreateSchemaId("log", 1, "{}");
+    execSql(dbPath, "CREATE TRIGGER fail_chunk BEFORE INSERT ON chunk_index WHEN NEW.offset_bytes = 1000000"
+                    " BEGIN SELECT RAISE(ABORT, 'injected'); END");
+    
+    LCMWriteQueue queue(lcm, 4);
+    std::vector<LCMWrite> writes;
+    for (int i = 0; i < 10; ++i) {
+        writes.push_back(makeRegistration("f" + std::to_string(i), 3, typeId, schemaId, i == 6 ? 1000000 : 0));
+        queue.post(writes.back());
+    }
+    
+    EXPECT_THROW(queue.flush(), std::runtime_error);
+    EXPECT_EQ(queue.getFailedWrites(), 1u);
+    EXPECT_NE(queue.getLastError().find("injected"), std::string::npos);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(lcm.findFileByContentHash(writes[i].file.contentHash).has_value(), i != 6);
+    }
+    
+    // Reported once
+    EXPECT_NO_THROW(queue.flush());
+}
+
+TEST(LCMManager, FindsNearDuplicatesInCrowdedBuckets) {
+    TempDir dir;
+    LCMManager lcm(dir / "lcm.db");
+    int typeId = lcm.getOrCreateFileTypeId("text", "txt");
+    int schemaId = lcm.getOrCreateSchemaId("log", 1, "{}");
+    
+    // Three bits off, one in each of the low bands: only the top band agrees
+    constexpr std::uint64_t signature = 0x0123456789ABCDEFULL;
+    constexpr std::uint64_t near = signature ^ 1 ^ (1ULL << 16) ^ (1ULL << 32);
+    constexpr std::uint64_t topBand = 0xFFFF000000000000ULL;
+    
+    std::vector<LCMWrite> writes = {makeRegistration("old", 1, typeId, schemaId)};
+    writes[0].chunks[0].simHash = near;
+    lcm.applyWrites(writes);
+    
+    auto matches = lcm.findSimilarChunks(signature, 3, 10);
+    ASSERT_EQ(matches.size(), 1u);
+    EXPECT_EQ(matches[0].fingerprint, writes[0].chunks[0].chunkFingerprint);
+    EXPECT_EQ(matches[0].similarity, 1.0 - 3.0 / 64.0);
+    
+    // Fill the shared bucket with newer, distant chunks: only the newest
+    // LSH_BUCKET_SCAN_LIMIT of them are read, so the old match drops out
+    writes = {makeRegistration("crowd", LCMManager::LSH_BUCKET_SCAN_LIMIT, typeId, schemaId, 4096),
+              makeRegistration("newest", 1, typeId, schemaId)};
+    for (std::size_t i = 0; i < writes[0].chunks.size(); ++i) {
+        writes[0].chunks[i].simHash = (signature & topBand) | ((~signature ^ i) & ~topBand);
+    }
+    writes[1].chunks[0].simHash = near;
+    lcm.applyWrites(writes);
+    
+    matches = lcm.findSimilarChunks(signature, 3, 10);
+    ASSERT_EQ(matches.size(), 1u);
+    EXPECT_EQ(matches[0].fingerprint, writes[1].chunks[0].chunkFingerprint);
+}
+
+TEST(LCMManager, StoresHashesAsCompactBlobs) {
+    TempDir dir;
+    auto dbPath = dir / "lcm.db";
+    LCMManager lcm(dbPath);
+    int typeId = lcm.getOrCreateFileTypeId("text", "txt");
+    int schemaId = lcm.getOrCreateSchemaId("log", 1, "{}");
+    
+    std::vector<LCMWrite> writes = {makeRegistration("a", 2, typeId, schemaId),
+                                    makeRegistration("b", 0, typeId, schemaId)};
+    writes[1].file.contentHash = "hand-written";
+    lcm.applyWrites(writes);
+    
+    // Hex hashes become BLOBs of their bytes; anything else stays TEXT
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM file_index WHERE typeof(content_hash) = 'blob'"), 1);
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM file_index WHERE typeof(content_hash) = 'text'"), 1);
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM file_index WHERE typeof(path_hash) = 'blob'"), 2);
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM chunk_index WHERE typeof(chunk_hash) = 'blob'"), 2);
+    EXPECT_LE(queryInt(dbPath, "SELECT MAX(length(chunk_hash)) FROM chunk_index"), 32);
+    
+    // Lookups take and return the hex form
+    for (const auto& write : writes) {
+        auto found = lcm.findFileByContentHash(write.file.contentHash);
+        ASSERT_TRUE(found.has_value());
+        EXPECT_EQ(found->contentHash, write.file.contentHash);
+        EXPECT_EQ(found->pathHash, write.file.pathHash);
+    }
+    EXPECT_EQ(lcm.findSimilarChunksByHash(writes[0].chunks[1].chunkHash, 1).size(), 1u);
+    EXPECT_FALSE(lcm.findFileByContentHash(std::string(64, '0')).has_value());
+}
+
+TEST(LCMManager, MigratesTextHashesFromOlderSchemas) {
+    TempDir dir;
+    auto dbPath = dir / "lcm.db";
+    
+    // Leading zero bytes are dropped from the stored BLOB; hand-written keys stay TEXT
+    std::vector<LCMWrite> writes;
+    {
+        LCMManager lcm(dbPath);
+        int typeId = lcm.getOrCreateFileTypeId("text", "txt");
+        int schemaId = lcm.getOrCreateSchemaId("log", 1, "{}");
+        writes = {makeRegistration("plain", 3, typeId, schemaId),
+                  makeRegistration("zeros", 0, typeId, schemaId),
+                  makeRegistration("legacy", 0, typeId, schemaId)};
+        writes[1].file.contentHash = std::string(60, '0') + "abcd";
+        writes[2].file.contentHash = "legacy-key";
+        lcm.applyWrites(writes);
+    }
+    
+    // Back to version 1: hex TEXT hashes, one chunk_index row per position
+    // (here a repeat of the first chunk) and no occurrences or file stats
+    const std::string zeros(64, '0');
+    for (const char* column : {"file_index.content_hash", "file_index.path_hash", "chunk_index.chunk_hash"}) {
+        std::string name(column);
+        std::string table = name.substr(0, name.find('.'));
+        std::string field = name.substr(name.find('.') + 1);
+        execSql(dbPath, "UPDATE " + table + " SET " + field + " = substr('" + zeros + "', 1, 64 - 2 * length(" +
+                            field + ")) || lower(hex(" + field + ")) WHERE typeof(" + field + ") = 'blob'");
+    }
+    execSql(dbPath, "DROP INDEX idx_chunk_hash_unique;"
+                    "INSERT INTO chunk_index (file_id, offset_bytes, length_bytes, chunk_hash, chunk_fingerprint, "
+                    "schema_id, seen_count) SELECT file_id, 100000, length_bytes, chunk_hash, chunk_fingerprint, "
+                    "schema_id, 2 FROM chunk_index WHERE offset_bytes = 0;"
+                    "DELETE FROM chunk_occurrences; DELETE FROM file_type_stats;"
+                    "UPDATE meta SET schema_version = 1");
+    ASSERT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM file_index WHERE typeof(content_hash) = 'text'"), 3);
+    
+    LCMManager lcm(dbPath);
+    EXPECT_EQ(queryInt(dbPath, "SELECT schema_version FROM meta"), 4);
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM file_index WHERE typeof(content_hash) = 'blob'"), 2);
+    EXPECT_EQ(queryInt(dbPath, "SELECT MIN(length(content_hash)) FROM file_index WHERE typeof(content_hash) = 'blob'"),
+              2);
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM chunk_index WHERE typeof(chunk_hash) = 'blob'"), 3);
+    for (const auto& write : writes) {
+        auto found = lcm.findFileByContentHash(write.file.contentHash);
+        ASSERT_TRUE(found.has_value());
+        EXPECT_EQ(found->contentHash, write.file.contentHash);
+        EXPECT_EQ(found->pathHash, write.file.pathHash);
+    }
+    
+    // The repeated chunk folds into the first row
+    auto repeated = lcm.findSimilarChunksByHash(writes[0].chunks[0].chunkHash, 10);
+    ASSERT_EQ(repeated.size(), 1u);
+    EXPECT_EQ(queryInt(dbPath, "SELECT seen_count FROM chunk_index WHERE offset_bytes = 0"), 3);
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM chunk_occurrences"), 4);
+    EXPECT_EQ(lcm.getTotalFilesTracked(), 3);
+}
+
+TEST(LCMManager, RepeatedChunksAccumulateInOneRow) {
+    TempDir dir;
+    auto dbPath = dir / "lcm.db";
+    LCMManager lcm(dbPath);
+    int typeId = lcm.getOrCreateFileTypeId("text", "txt");
+    int schemaId = lcm.getOrCreateSchemaId("log", 1, "{}");
+    
+    auto chunkAt = [&](const std::string& content, std::int64_t offset, std::int64_t seenCount) {
+        FileChunkInfo chunk = makeChunk(content, offset, schemaId);
+        chunk.chunkHash = hashOf("chunk:" + content);
+        chunk.seenCount = seenCount;
+        chunk.simHash = std::hash<std::string>{}(content);
+        return chunk;
+    };
+    
+    // "shared" occurs twice within the first file's single INSERT, and once
+    // more, counted as three sightings, in the second file
+    LCMWrite first = makeRegistration("first", 0, typeId, schemaId);
+    first.chunks = {chunkAt("shared", 0, 1), chunkAt("one", 4096, 1), chunkAt("shared", 8192, 1)};
+    LCMWrite second = makeRegistration("second", 0, typeId, schemaId);
+    second.chunks = {chunkAt("two", 0, 1), chunkAt("shared", 4096, 3)};
+    std::vector<LCMWrite> writes = {first};
+    lcm.applyWrites(writes);
+    EXPECT_EQ(queryInt(dbPath, "SELECT seen_count FROM chunk_index WHERE offset_bytes = 0"), 2);
+    writes = {second};
+    lcm.applyWrites(writes);
+    
+    std::string sharedRow = "SELECT chunk_id FROM chunk_index WHERE seen_count = 5";
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM chunk_index"), 3);
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM (" + sharedRow + ")"), 1);
+    EXPECT_EQ(lcm.findSimilarChunksByHash(first.chunks[0].chunkHash, 10).size(), 1u);
+    
+    // Every position is kept as an occurrence of the one row
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM chunk_occurrences"), 5);
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM chunk_occurrences WHERE chunk_id = (" + sharedRow + ")"), 3);
+    
+    // A repeated chunk is indexed for near-duplicate search only once
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM chunk_similarity WHERE chunk_id = (" + sharedRow + ")"),
+              LCMManager::LSH_BANDS);
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM chunk_similarity"), 3 * LCMManager::LSH_BANDS);
+}
+
+TEST(LCMRetention, ExpiresOldFilesAndTheirOrphanedChunks) {
+    TempDir dir;
+    auto dbPath = dir / "lcm.db";
+    LCMManager lcm(dbPath);
+    int typeId = lcm.getOrCreateFileTypeId("text", "txt");
+    int schemaId = lcm.getOrCreateSchemaId("log", 1, "{}");
+    
+    // "fresh" repeats the first chunk of "old", which must survive with its
+    // first position moved to "fresh"
+    std::vector<LCMWrite> writes = {makeRegistration("old", 3, typeId, schemaId),
+                                    makeRegistration("fresh", 2, typeId, schemaId, 1000000)};
+    writes[1].file.lastSeenAt = getCurrentTimestamp();
+    FileChunkInfo shared = writes[0].chunks[0];
+    shared.offsetBytes = 2000000;
+    writes[1].chunks.push_back(shared);
+    lcm.applyWrites(writes);
+    
+    LCMRetentionPolicy policy;
+    policy.maxAgeDays = 30;
+    LCMRetentionResult result = lcm.applyRetention(policy);
+    EXPECT_EQ(result.filesRemoved, 1);
+    EXPECT_EQ(result.chunksRemoved, 2);
+    
+    EXPECT_FALSE(lcm.findFileByContentHash(writes[0].file.contentHash).has_value());
+    ASSERT_TRUE(lcm.findFileByContentHash(writes[1].file.contentHash).has_value());
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM chunk_index"), 3);
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM chunk_occurrences"), 3);
+    EXPECT_EQ(queryInt(dbPath, "SELECT offset_bytes FROM chunk_index WHERE seen_count = 1 AND offset_bytes = 2000000"),
+              2000000);
+    
+    // Nothing left to expire
+    result = lcm.applyRetention(policy);
+    EXPECT_EQ(result.filesRemoved, 0);
+    EXPECT_EQ(result.chunksRemoved, 0);
+}
+
+TEST(LCMRetention, CapsChunksPerFileType) {
+    TempDir dir;
+    auto dbPath = dir / "lcm.db";
+    LCMManager lcm(dbPath);
+    int textType = lcm.getOrCreateFileTypeId("text", "txt");
+    int csvType = lcm.getOrCreateFileTypeId("csv", "csv");
+    int schemaId = lcm.getOrCreateSchemaId("log", 1, "{}");
+    
+    std::vector<LCMWrite> writes = {makeRegistration("a.txt", 5, textType, schemaId),
+                                    makeRegistration("b.csv", 2, csvType, schemaId)};
+    for (std::size_t i = 0; i < writes[0].chunks.size(); ++i) {
+        writes[0].chunks[i].seenCount = static_cast<std::int64_t>(i) + 1;
+    }
+    lcm.applyWrites(writes);
+    
+    LCMRetentionPolicy policy;
+    policy.maxChunksPerFileType = 2;
+    LCMRetentionResult result = lcm.applyRetention(policy);
+    EXPECT_EQ(result.filesRemoved, 0);
+    EXPECT_EQ(result.chunksRemoved, 3);
+    
+    // The most-seen chunks of each type remain
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM chunk_index"), 4);
+    EXPECT_EQ(queryInt(dbPath, "SELECT MIN(seen_count) FROM chunk_index WHERE offset_bytes >= 3 * 4096"), 4);
+    EXPECT_EQ(lcm.findSimilarChunksByHash(writes[0].chunks[0].chunkHash, 1).size(), 0u);
+    EXPECT_EQ(lcm.findSimilarChunksByHash(writes[0].chunks[4].chunkHash, 1).size(), 1u);
+    EXPECT_EQ(lcm.findSimilarChunksByHash(writes[1].chunks[0].chunkHash, 1).size(), 1u);
+}
+
+TEST(LCMRetention, ConcurrentRunsDoNotShareWorkTables) {
+    TempDir dir;
+    auto dbPath = dir / "lcm.db";
+    LCMManager lcm(dbPath);
+    int typeId = lcm.getOrCreateFileTypeId("text", "txt");
+    int schemaId = lcm.getOrCreateSchemaId("log", 1, "{}");
+    
+    // Several batches' worth of expired files
+    constexpr int expiredFiles = 3 * LCMManager::RETENTION_BATCH_ROWS;
+    std::vector<LCMWrite> writes;
+    for (int i = 0; i < expiredFiles; ++i) {
+        writes.push_back(makeRegistration("old" + std::to_string(i), 1, typeId, schemaId));
+    }
+    lcm.applyWrites(writes);
+    
+    LCMRetentionPolicy policy;
+    policy.maxAgeDays = 30;
+    std::vector<LCMRetentionResult> results(2);
+    std::vector<std::string> errors(2);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < results.size(); ++t) {
+        threads.emplace_back([&, t] {
+            try {
+                results[t] = lcm.applyRetention(policy);
+            } catch (const std::exception& e) {
+                errors[t] = e.what();
+            }
+        });
+    }
+    
+    // A writer interleaves with the batches
+    std::vector<LCMWrite> fresh = {makeRegistration("fresh", 4, typeId, schemaId, 1000000)};
+    fresh[0].file.lastSeenAt = getCurrentTimestamp();
+    lcm.applyWrites(fresh);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    EXPECT_EQ(errors[0], "");
+    EXPECT_EQ(errors[1], "");
+    EXPECT_EQ(results[0].filesRemoved + results[1].filesRemoved, expiredFiles);
+    EXPECT_EQ(results[0].chunksRemoved + results[1].chunksRemoved, expiredFiles);
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM file_index"), 1);
+    EXPECT_EQ(queryInt(dbPath, "SELECT COUNT(*) FROM chunk_index"), 4);
+}
+
+TEST(LCMManager, KeepsFileTypeStatisticsCurrent) {
+    TempDir dir;
+    auto dbPath = dir / "lcm.db";
+    LCMManager lcm(dbPath);
+    int textType = lcm.getOrCreateFileTypeId("text", "txt");
+    int csvType = lcm.getOrCreateFileTypeId("csv", "csv");
+    int schemaId = lcm.getOrCreateSchemaId("log", 1, "{}");
+    EXPECT_EQ(lcm.getTotalFilesTracked(), 0);
+    EXPECT_EQ(lcm.getTotalCorpusSize(), 0);
+    EXPECT_TRUE(lcm.getTopFileTypes(10).empty());
+    
+    std::vector<LCMWrite> writes;
+    for (int i = 0; i < 3; ++i) {
+        writes.push_back(makeRegistration("t" + std::to_string(i), 2, textType, schemaId));
+    }
+    writes.push_back(makeRegistration("c0", 5, csvType, schemaId));
+    
+    // A file that is rolled back leaves the statistics untouched
+    execSql(dbPath, "CREATE TRIGGER fail_chunk BEFORE INSERT ON chunk_index WHEN NEW.offset_bytes = 1000000"
+                    " BEGIN SELECT RAISE(ABORT, 'injected'); END");
+    writes.push_back(makeRegistration("failing", 3, csvType, schemaId, 1000000));
+    EXPECT_EQ(lcm.applyWrites(writes).size(), 1u);
+    
+    EXPECT_EQ(lcm.getTotalFilesTracked(), 4);
+    EXPECT_EQ(lcm.getTotalCorpusSize(), (3 * 2 + 5) * 4096);
+    auto top = lcm.getTopFileTypes(10);
+    ASSERT_EQ(top.size(), 2u);
+    EXPECT_EQ(top[0], std::make_pair(textType, std::int64_t{3}));
+    EXPECT_EQ(top[1], std::make_pair(csvType, std::int64_t{1}));
+    EXPECT_EQ(lcm.getTopFileTypes(1).size(), 1u);
+    
+    // The statistics are stored with the data and survive reopening
+    lcm = LCMManager(dbPath);
+    EXPECT_EQ(lcm.getTotalFilesTracked(), 4);
+    EXPECT_EQ(lcm.getTotalCorpusSize(), (3 * 2 + 5) * 4096);
+    EXPECT_EQ(queryInt(dbPath, "SELECT SUM(file_count) FROM file_type_stats"), 4);
+    
+    // Retention removes files through the same triggers
+    LCMRetentionPolicy policy;
+    policy.maxAgeDays = 30;
+    lcm.applyRetention(policy);
+    EXPECT_EQ(lcm.getTotalFilesTracked(), 0);
+    EXPECT_EQ(lcm.getTotalCorpusSize(), 0);
+    EXPECT_TRUE(lcm.getTopFileTypes(10).empty());
+}
+
+TEST(LCMManager, ReadersRunAlongsideTheWriter) {
+    TempDir dir;
+    LCMManager lcm(dir / "lcm.db");
+    int typeId = lcm.getOrCreateFileTypeId("text", "txt");
+    int schemaId = lcm.getOrCreateSchemaId("log", 1, "{}");
+    
+    std::vector<LCMWrite> existing;
+    for (int i = 0; i < 50; ++i) {
+        existing.push_back(makeRegistration("r" + std::to_string(i), 2, typeId, schemaId));
+    }
+    lcm.applyWrites(existing);
+    
+    // Readers check committed files while the writer keeps adding more.
+    // There are more of them than the pool opens connections (at most 16),
+    // so some wait for a connection to be released.
+    std::atomic<bool> writing{true};
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 20; ++t) {
+        readers.emplace_back([&, t] {
+            int rounds = 0;
+            while (writing.load() || rounds < 10) {
+                const LCMWrite& write = existing[static_cast<std::size_t>(rounds * 7 + t) % existing.size()];
+                auto found = lcm.findFileByContentHash(write.file.contentHash);
+                if (!found || found->pathHash != write.file.pathHash ||
+                    lcm.findSimilarChunksByHash(write.chunks[1].chunkHash, 1).size() != 1 ||
+                    lcm.getFileTypeName(typeId) != "text" || lcm.loadSchemaDefinition(schemaId) != "{}") {
+                    ++mismatches;
+                }
+                ++rounds;
+            }
+        });
+    }
+    
+    for (int batch = 0; batch < 20; ++batch) {
+        std::vector<LCMWrite> writes;
+        for (int i = 0; i < 20; ++i) {
+            writes.push_back(makeRegistration("w" + std::to_string(batch) + "-" + std::to_string(i), 4, typeId,
+                                              schemaId));
+        }
+        lcm.applyWrites(writes);
+    }
+    writing.store(false);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    
+    EXPECT_EQ(mismatches.load(), 0);
+    EXPECT_EQ(lcm.getTotalFilesTracked(), 50 + 20 * 20);
+}
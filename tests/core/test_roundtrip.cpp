@@ -0,0 +1,933 @@
+#include "TestSupport.h"
+#include "compression/CompressionEngine.h"
+#include "container/RDXMerge.h"
+#include "container/RDXReader.h"
+#include "container/RDXWriter.h"
+#include "decompression/DecompressionEngine.h"
+#include "lcm/LCMManager.h"
+#include "schemas/SchemaRegistry.h"
+#include "util/BlockingQueue.h"
+#include "util/ParallelFor.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace rdx::core;
+using rdx::test::TempDir;
+using rdx::test::randomContent;
+using rdx::test::readFile;
+using rdx::test::textContent;
+using rdx::test::writeFile;
+
+namespace {
+
+// One LCM and engine pair per test, all below a temporary directory
+struct ArchiveFixture {
+    TempDir dir;
+    LCMManager lcm{dir / "lcm.db"};
+    SchemaRegistry registry{lcm};
+    CompressionEngine compressor{lcm, registry};
+    DecompressionEngine decompressor;
+    
+    // Writes `content` to an input file and adds it under `name`
+    void add(RDXWriter& writer, const std::string& name, const std::string& content) {
+        auto input = dir / ("in/" + name);
+        writeFile(input, content);
+        writer.addFile(input, compressor, name);
+    }
+    
+    std::string extract(const RDXReader& reader, const RDXEntry& entry) {
+        auto output = dir / ("out/" + entry.fileName);
+        std::filesystem::create_directories(output.parent_path());
+        reader.extractEntry(entry, output, decompressor);
+        return readFile(output);
+    }
+    
+    // Extracts every entry and compares it with `expected` (name -> content)
+    void expectContents(const std::filesystem::path& archive,
+                        const std::map<std::string, std::string>& expected) {
+        RDXReader reader(archive);
+        std::vector<RDXEntry> entries;
+        reader.listEntries(entries);
+        ASSERT_EQ(entries.size(), expected.size());
+        for (const auto& entry : entries) {
+            auto it = expected.find(entry.fileName);
+            ASSERT_TRUE(it != expected.end());
+            EXPECT_EQ(extract(reader, entry), it->second);
+        }
+    }
+};
+
+} // namespace
+
+TEST(RoundTrip, ExtractsEveryEntry) {
+    ArchiveFixture f;
+    std::map<std::string, std::string> files = {
+        {"log.txt", textContent(100000, 1)},
+        {"data.bin", randomContent(70000, 2)},
+        {"empty.txt", ""},
+    };
+    {
+        RDXWriter writer(f.dir / "a.rdx");
+        for (const auto& [name, content] : files) {
+            f.add(writer, name, content);
+        }
+        writer.finalize();
+    }
+    f.expectContents(f.dir / "a.rdx", files);
+}
+
+TEST(AppendMode, AddsEntriesWithoutRewritingBlocks) {
+    ArchiveFixture f;
+    auto archive = f.dir / "a.rdx";
+    std::map<std::string, std::string> files = {
+        {"one.txt", textContent(30000, 1)},
+        {"two.bin", randomContent(20000, 2)},
+    };
+    {
+        RDXWriter writer(archive);
+        f.add(writer, "one.txt", files["one.txt"]);
+        f.add(writer, "two.bin", files["two.bin"]);
+    }
+    // Blocks written so far; the header is rewritten with the new index offset
+    std::int64_t blocksEnd = RDXReader(archive).getIndexOffset();
+    std::string before = readFile(archive).substr(RDX_HEADER_SIZE, blocksEnd - RDX_HEADER_SIZE);
+    
+    files["three.txt"] = textContent(40000, 3);
+    {
+        RDXWriter writer(archive, RDXOpenMode::Append);
+        f.add(writer, "three.txt", files["three.txt"]);
+        writer.finalize();
+    }
+    
+    EXPECT_EQ(readFile(archive).substr(RDX_HEADER_SIZE, before.size()), before);
+    f.expectContents(archive, files);
+}
+
+TEST(AppendMode, ReopeningWithoutChangesKeepsEntries) {
+    ArchiveFixture f;
+    auto archive = f.dir / "a.rdx";
+    std::map<std::string, std::string> files = {{"one.txt", textContent(5000, 1)}};
+    {
+        RDXWriter writer(archive);
+        f.add(writer, "one.txt", files["one.txt"]);
+    }
+    {
+        RDXWriter writer(archive, RDXOpenMode::Append);
+    }
+    f.expectContents(archive, files);
+}
+
+TEST(AppendMode, CreatesMissingArchive) {
+    ArchiveFixture f;
+    auto archive = f.dir / "new.rdx";
+    std::map<std::string, std::string> files = {{"one.txt", textContent(5000, 1)}};
+    {
+        RDXWriter writer(archive, RDXOpenMode::Append);
+        f.add(writer, "one.txt", files["one.txt"]);
+    }
+    f.expectContents(archive, files);
+}
+
+TEST(ParallelExtraction, WritesOnlyTheLastEntryOfAName) {
+    ArchiveFixture f;
+    auto archive = f.dir / "a.rdx";
+    std::string older = randomContent(200000, 1);
+    std::string newer = randomContent(3 << 20, 2);
+    {
+        RDXWriter writer(archive);
+        f.add(writer, "data.bin", older);
+        f.add(writer, "other.txt", textContent(10000, 3));
+    }
+    {
+        RDXWriter writer(archive, RDXOpenMode::Append);
+        f.add(writer, "data.bin", newer);
+    }
+    
+    RDXReader reader(archive);
+    auto results = reader.extractAll(f.dir / "many", f.decompressor, 4);
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_TRUE(results[0].success);
+    EXPECT_TRUE(results[0].superseded);
+    EXPECT_FALSE(results[1].superseded);
+    EXPECT_TRUE(results[2].success);
+    EXPECT_FALSE(results[2].superseded);
+    EXPECT_EQ(readFile(f.dir / "many/data.bin"), newer);
+    
+    // With the small budget the older version would go to the write-behind
+    // thread while the newer one is streamed past it
+    std::vector<RDXEntry> entries;
+    reader.listEntries(entries);
+    for (std::size_t budget : {std::size_t(64) << 20, std::size_t(1) << 20}) {
+        RDXPipelineOptions options;
+        options.maxInFlightBytes = budget;
+        auto output = f.dir / ("sequential-" + std::to_string(budget));
+        results = reader.extractSequential(entries, output, f.decompressor, options);
+        EXPECT_TRUE(results[0].superseded);
+        EXPECT_TRUE(results[2].success);
+        EXPECT_EQ(readFile(output / "data.bin"), newer);
+    }
+}
+
+namespace {
+
+// Flips one byte of `path` in place
+void corruptByte(const std::filesystem::path& path, std::int64_t offset) {
+    std::string content = readFile(path);
+    content[static_cast<std::size_t>(offset)] ^= 0x5A;
+    writeFile(path, content);
+}
+
+} // namespace
+
+TEST(Verify, AcceptsIntactArchive) {
+    ArchiveFixture f;
+    {
+        RDXWriter writer(f.dir / "a.rdx");
+        f.add(writer, "one.txt", textContent(50000, 1));
+        f.add(writer, "two.bin", randomContent(50000, 2));
+    }
+    RDXReader reader(f.dir / "a.rdx");
+    RDXVerifyReport fast = reader.verifyArchive(2);
+    EXPECT_TRUE(fast.ok());
+    EXPECT_EQ(fast.entriesChecked, 2u);
+    EXPECT_EQ(fast.entriesWithoutChecksums, 0u);
+    EXPECT_TRUE(reader.verifyArchive(f.decompressor, 2).ok());
+}
+
+TEST(Verify, ReportsCorruptedBlock) {
+    ArchiveFixture f;
+    auto archive = f.dir / "a.rdx";
+    {
+        RDXWriter writer(archive);
+        f.add(writer, "one.txt", textContent(50000, 1));
+        f.add(writer, "two.bin", randomContent(50000, 2));
+    }
+    const RDXEntry* damaged = nullptr;
+    std::vector<RDXEntry> entries;
+    RDXReader(archive).listEntries(entries);
+    for (const auto& entry : entries) {
+        if (entry.fileName == "two.bin") {
+            damaged = &entry;
+        }
+    }
+    ASSERT_TRUE(damaged != nullptr);
+    corruptByte(archive, damaged->offset + damaged->blockSize - 10);
+    
+    RDXReader reader(archive);
+    for (RDXVerifyReport report : {reader.verifyArchive(2), reader.verifyArchive(f.decompressor, 2)}) {
+        ASSERT_EQ(report.issues.size(), 1u);
+        EXPECT_EQ(report.issues[0].fileName, "two.bin");
+    }
+    EXPECT_THROW(f.extract(reader, *damaged), std::runtime_error);
+}
+
+namespace {
+
+template <typename T>
+void appendField(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Rewrites `source` as a format version 1 archive with version 1 blocks (no
+// checksums, no zero extents), as written before block checksums existed
+void writeVersion1Archive(const RDXReader& source, const std::filesystem::path& outputPath) {
+    std::vector<RDXEntry> entries;
+    source.listEntries(entries);
+    
+    std::string archive;
+    appendField(archive, RDX_MAGIC);
+    appendField<std::uint16_t>(archive, 1);
+    appendField<std::uint16_t>(archive, 0);
+    appendField<std::int64_t>(archive, 0);  // Index offset, patched below
+    
+    for (auto& entry : entries) {
+        ByteBuffer structStream;
+        ByteBuffer residualStream;
+        source.readBlock(entry, structStream, residualStream);
+        
+        std::int64_t offset = static_cast<std::int64_t>(archive.size());
+        appendField(archive, RDX_BLOCK_MAGIC_V1);
+        appendField(archive, RDX_BLOCK_HEADER_SIZE_V1);
+        appendField<std::int32_t>(archive, entry.schemaId);
+        appendField<std::int32_t>(archive, entry.fileTypeId);
+        appendField(archive, entry.originalSize);
+        appendField(archive, entry.compressedStructSize);
+        appendField(archive, entry.compressedResidualSize);
+        appendField<std::uint16_t>(archive, 0);
+        archive.append(reinterpret_cast<const char*>(structStream.data().data()), structStream.size());
+        archive.append(reinterpret_cast<const char*>(residualStream.data().data()), residualStream.size());
+        entry.offset = offset;
+        entry.blockSize = static_cast<std::int64_t>(archive.size()) - offset;
+    }
+    
+    std::int64_t indexOffset = static_cast<std::int64_t>(archive.size());
+    appendField<std::uint32_t>(archive, static_cast<std::uint32_t>(entries.size()));
+    for (const auto& entry : entries) {
+        appendField<std::uint32_t>(archive, static_cast<std::uint32_t>(entry.fileName.size()));
+        archive += entry.fileName;
+        appendField(archive, entry.originalSize);
+        appendField(archive, entry.compressedStructSize);
+        appendField(archive, entry.compressedResidualSize);
+        appendField<std::int32_t>(archive, entry.schemaId);
+        appendField<std::int32_t>(archive, entry.fileTypeId);
+        appendField(archive, entry.offset);
+        appendField(archive, entry.blockSize);
+    }
+    std::memcpy(archive.data() + 8, &indexOffset, sizeof(indexOffset));
+    writeFile(outputPath, archive);
+}
+
+} // namespace
+
+TEST(FormatVersions, ReadsVersion1Archive) {
+    ArchiveFixture f;
+    std::map<std::string, std::string> files = {
+        {"one.txt", textContent(40000, 1)},
+        {"two.bin", randomContent(30000, 2)},
+    };
+    {
+        RDXWriter writer(f.dir / "current.rdx");
+        for (const auto& [name, content] : files) {
+            f.add(writer, name, content);
+        }
+    }
+    writeVersion1Archive(RDXReader(f.dir / "current.rdx"), f.dir / "v1.rdx");
+    
+    f.expectContents(f.dir / "v1.rdx", files);
+    RDXReader reader(f.dir / "v1.rdx");
+    RDXVerifyReport report = reader.verifyArchive(f.decompressor, 2);
+    EXPECT_TRUE(report.ok());
+    EXPECT_EQ(report.entriesWithoutChecksums, 2u);
+    EXPECT_FALSE(reader.getContentChecksum(*reader.findEntry("one.txt")).has_value());
+}
+
+TEST(FormatVersions, AppendsToVersion1Archive) {
+    ArchiveFixture f;
+    std::map<std::string, std::string> files = {{"one.txt", textContent(40000, 1)}};
+    {
+        RDXWriter writer(f.dir / "current.rdx");
+        f.add(writer, "one.txt", files["one.txt"]);
+    }
+    writeVersion1Archive(RDXReader(f.dir / "current.rdx"), f.dir / "v1.rdx");
+    
+    files["two.txt"] = textContent(20000, 2);
+    {
+        RDXWriter writer(f.dir / "v1.rdx", RDXOpenMode::Append);
+        f.add(writer, "two.txt", files["two.txt"]);
+    }
+    f.expectContents(f.dir / "v1.rdx", files);
+    RDXVerifyReport report = RDXReader(f.dir / "v1.rdx").verifyArchive(2);
+    EXPECT_TRUE(report.ok());
+    EXPECT_EQ(report.entriesWithoutChecksums, 1u);
+}
+
+TEST(StreamingArchive, RoundTripsThroughNonSeekableSink) {
+    ArchiveFixture f;
+    std::map<std::string, std::string> files = {
+        {"one.txt", textContent(80000, 1)},
+        {"two.bin", randomContent(30000, 2)},
+    };
+    std::ostringstream stream;
+    {
+        RDXWriter writer(std::make_unique<StreamSink>(stream));
+        for (const auto& [name, content] : files) {
+            f.add(writer, name, content);
+        }
+        writer.finalize();
+    }
+    writeFile(f.dir / "streamed.rdx", stream.str());
+    f.expectContents(f.dir / "streamed.rdx", files);
+    EXPECT_TRUE(RDXReader(f.dir / "streamed.rdx").verifyArchive(f.decompressor).ok());
+}
+
+TEST(StreamingArchive, NonSeekableSinksRejectWriteAt) {
+    std::ostringstream stream;
+    StreamSink sink(stream);
+    std::byte data[4] = {};
+    EXPECT_FALSE(sink.canSeek());
+    EXPECT_THROW(sink.writeAt(0, data), std::logic_error);
+}
+
+TEST(StreamingArchive, DestructorSwallowsFinalizeErrors) {
+    ArchiveFixture f;
+    bool failing = false;
+    auto sink = std::make_unique<CallbackSink>([&](std::span<const std::byte>) {
+        if (failing) {
+            throw std::runtime_error("sink closed");
+        }
+    });
+    EXPECT_NO_THROW({
+        RDXWriter writer(std::move(sink));
+        f.add(writer, "one.txt", textContent(1000, 1));
+        failing = true;
+    });
+    
+    failing = false;
+    RDXWriter writer(std::make_unique<CallbackSink>([&](std::span<const std::byte>) {
+        if (failing) {
+            throw std::runtime_error("sink closed");
+        }
+    }));
+    f.add(writer, "one.txt", textContent(1000, 1));
+    failing = true;
+    EXPECT_THROW(writer.finalize(), std::runtime_error);
+}
+
+TEST(IOBackends, SequentialExtractionMatchesWithEveryBackend) {
+    ArchiveFixture f;
+    std::map<std::string, std::string> files;
+    {
+        RDXWriter writer(f.dir / "a.rdx");
+        for (unsigned i = 0; i < 12; ++i) {
+            std::string name = "file" + std::to_string(i) + ".txt";
+            files[name] = i % 3 == 0 ? randomContent(300000, i) : textContent(20000 * (i + 1), i);
+            f.add(writer, name, files[name]);
+        }
+    }
+    RDXReader reader(f.dir / "a.rdx");
+    std::vector<RDXEntry> entries;
+    reader.listEntries(entries);
+    
+    for (IOBackendKind backend : {IOBackendKind::Positional, IOBackendKind::IoUring}) {
+        RDXPipelineOptions options;
+        options.ioBackend = backend;
+        options.queueDepth = 3;
+        options.maxInFlightBytes = 512 * 1024;  // Large entries bypass write-behind
+        
+        auto outputDir = f.dir / ("out-" + std::to_string(static_cast<int>(backend)));
+        auto results = reader.extractSequential(entries, outputDir, f.decompressor, options);
+        ASSERT_EQ(results.size(), entries.size());
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            EXPECT_TRUE(results[i].success);
+            EXPECT_EQ(readFile(outputDir / entries[i].fileName), files[entries[i].fileName]);
+        }
+    }
+}
+
+TEST(IOBackends, FileSinkWritesAndPatchesWithEveryBackend) {
+    TempDir dir;
+    std::string content = randomContent(5 * 1024 * 1024 + 123, 7);
+    
+    for (IOBackendKind backend : {IOBackendKind::Positional, IOBackendKind::IoUring}) {
+        auto path = dir / ("sink-" + std::to_string(static_cast<int>(backend)));
+        std::string expected = content;
+        {
+            FileSink sink(path, backend);
+            auto bytes = reinterpret_cast<const std::byte*>(content.data());
+            for (std::size_t offset = 0; offset < content.size(); offset += 777777) {
+                std::size_t length = std::min<std::size_t>(777777, content.size() - offset);
+                sink.write(std::span<const std::byte>(bytes + offset, length));
+            }
+            std::string patch = "patched";
+            sink.writeAt(10, std::as_bytes(std::span<const char>(patch.data(), patch.size())));
+            expected.replace(10, patch.size(), patch);
+            sink.close();
+        }
+        EXPECT_EQ(readFile(path), expected);
+    }
+}
+
+TEST(ZeroExtents, StoredOutOfBandAndRestoredExactly) {
+    ArchiveFixture f;
+    
+    // Data that ends mid-block on both sides of a 1 MiB zero run, and a
+    // zero tail that ends in a partial block
+    std::string sparse = randomContent(100000, 1) + std::string(1 << 20, '\0') + randomContent(50000, 2) +
+                         std::string(512 * 1024, '\0');
+    std::map<std::string, std::string> files = {
+        {"sparse.bin", sparse},
+        {"zeros.bin", std::string(256 * 1024, '\0')},
+        {"short-run.bin", randomContent(10000, 3) + std::string(32 * 1024, '\0') + randomContent(10000, 4)},
+    };
+    {
+        RDXWriter writer(f.dir / "a.rdx");
+        for (const auto& [name, content] : files) {
+            f.add(writer, name, content);
+        }
+    }
+    
+    RDXReader reader(f.dir / "a.rdx");
+    const RDXEntry* entry = reader.findEntry("sparse.bin");
+    ASSERT_TRUE(entry != nullptr);
+    
+    // Only whole 4 KiB blocks of zeros: the run's partial blocks stay stored
+    ASSERT_EQ(entry->zeroExtents.size(), 2u);
+    EXPECT_EQ(entry->zeroExtents[0].offset, 25 * 4096);
+    EXPECT_EQ(entry->zeroExtents[0].length, 280 * 4096 - 25 * 4096);
+    EXPECT_EQ(entry->zeroExtents[1].offset, 293 * 4096);
+    EXPECT_EQ(entry->zeroExtents[1].offset + entry->zeroExtents[1].length,
+              static_cast<std::int64_t>(sparse.size()));
+    ASSERT_EQ(reader.findEntry("zeros.bin")->zeroExtents.size(), 1u);
+    EXPECT_EQ(reader.findEntry("zeros.bin")->zeroExtents[0].length, 256 * 1024);
+    EXPECT_TRUE(reader.findEntry("short-run.bin")->zeroExtents.empty());
+    
+    // The extents are left out of the compressed content entirely
+    ByteBuffer structStream;
+    ByteBuffer residualStream;
+    ByteBuffer packed;
+    reader.readBlock(*entry, structStream, residualStream);
+    f.decompressor.decompressPacked(*entry, structStream.data(), residualStream.data(), packed);
+    EXPECT_EQ(static_cast<std::int64_t>(packed.size()), entry->originalSize - totalZeroBytes(entry->zeroExtents));
+    EXPECT_LT(entry->compressedStructSize + entry->compressedResidualSize,
+              static_cast<std::int64_t>(packed.size()) + 4096);
+    
+    // Every extraction path restores the content byte for byte
+    f.expectContents(f.dir / "a.rdx", files);
+    std::vector<RDXEntry> entries;
+    reader.listEntries(entries);
+    auto many = f.dir / "many";
+    reader.extractMany(entries, many, f.decompressor, 2);
+    auto sequential = f.dir / "sequential";
+    RDXPipelineOptions options;
+    options.maxInFlightBytes = 256 * 1024;  // sparse.bin is streamed, the others written behind
+    reader.extractSequential(entries, sequential, f.decompressor, options);
+    for (const auto& [name, content] : files) {
+        EXPECT_EQ(readFile(many / name), content);
+        EXPECT_EQ(readFile(sequential / name), content);
+        EXPECT_EQ(std::filesystem::file_size(sequential / name), content.size());
+    }
+}
+
+TEST(DirectoryIngest, AddsNestedTreeUnderPrefix) {
+    ArchiveFixture f;
+    std::map<std::string, std::string> files;
+    for (unsigned i = 0; i < 40; ++i) {
+        std::string relative = "d" + std::to_string(i % 4) + "/s" + std::to_string(i % 3) +
+                               "/f" + std::to_string(i) + ".txt";
+        files["tree/" + relative] = textContent(1000 + i * 100, i);
+        writeFile(f.dir / ("tree/" + relative), files["tree/" + relative]);
+    }
+    {
+        RDXWriter writer(f.dir / "a.rdx");
+        DirectoryWalkOptions options;
+        options.threadCount = 3;
+        RDXDirectoryResult result = writer.addDirectory(f.dir / "tree", f.compressor, "", options);
+        EXPECT_EQ(result.filesAdded, files.size());
+        EXPECT_TRUE(result.failures.empty());
+    }
+    f.expectContents(f.dir / "a.rdx", files);
+}
+
+TEST(BlockingQueue, PushWaitsWhileFull) {
+    BlockingQueue<int> queue(2);
+    queue.push(1);
+    queue.push(2);
+    
+    std::atomic<bool> pushed{false};
+    std::thread producer([&] {
+        queue.push(3);
+        pushed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(pushed.load());
+    
+    EXPECT_EQ(queue.pop(), std::optional<int>(1));
+    producer.join();
+    EXPECT_TRUE(pushed.load());
+    queue.close();
+    EXPECT_EQ(queue.pop(), std::optional<int>(2));
+    EXPECT_EQ(queue.pop(), std::optional<int>(3));
+    EXPECT_FALSE(queue.pop().has_value());
+}
+
+TEST(Merge, DropsSupersededAndSharesDuplicates) {
+    ArchiveFixture f;
+    std::string shared = textContent(60000, 5);
+    {
+        RDXWriter writer(f.dir / "a.rdx");
+        f.add(writer, "a/one.txt", shared);
+        f.add(writer, "common.txt", textContent(10000, 1));
+    }
+    {
+        RDXWriter writer(f.dir / "b.rdx");
+        f.add(writer, "b/copy.txt", shared);
+        f.add(writer, "common.txt", textContent(12000, 2));
+    }
+    
+    RDXReader a(f.dir / "a.rdx");
+    RDXReader b(f.dir / "b.rdx");
+    RDXMergeResult result;
+    {
+        RDXWriter writer(f.dir / "merged.rdx");
+        RDXMergeOptions options;
+        options.shareDuplicates = true;
+        result = mergeArchives({&a, &b}, writer, options);
+        writer.finalize();
+    }
+    EXPECT_EQ(result.entriesCopied, 2u);
+    EXPECT_EQ(result.entriesShared, 1u);
+    EXPECT_EQ(result.entriesDropped, 1u);
+    f.expectContents(f.dir / "merged.rdx", {
+        {"a/one.txt", shared},
+        {"b/copy.txt", shared},
+        {"common.txt", textContent(12000, 2)},
+    });
+    EXPECT_TRUE(RDXReader(f.dir / "merged.rdx").verifyArchive(f.decompressor).ok());
+}
+
+TEST(Merge, SharedEntriesMustReferToBlocksOfThisArchive) {
+    ArchiveFixture f;
+    RDXWriter writer(f.dir / "a.rdx");
+    f.add(writer, "one.txt", textContent(2000, 1));
+    RDXEntry own = writer.getEntries().back();
+    EXPECT_NO_THROW(writer.addSharedEntry(own, "alias.txt"));
+    
+    RDXEntry stray = own;
+    stray.offset += 1;
+    EXPECT_THROW(writer.addSharedEntry(stray, "bad.txt"), std::invalid_argument);
+    RDXEntry resized = own;
+    resized.blockSize -= 1;
+    EXPECT_THROW(writer.addSharedEntry(resized, "bad.txt"), std::invalid_argument);
+}
+
+namespace {
+
+const RDXEntry& entryNamed(const std::vector<RDXEntry>& entries, const std::string& name) {
+    auto it = std::find_if(entries.begin(), entries.end(), [&](const RDXEntry& entry) {
+        return entry.fileName == name;
+    });
+    if (it == entries.end()) {
+        throw std::runtime_error("no entry " + name);
+    }
+    return *it;
+}
+
+} // namespace
+
+TEST(DeltaArchive, ReferencesAndDeltasRoundTrip) {
+    ArchiveFixture f;
+    std::string changed = textContent(60000, 3);
+    std::map<std::string, std::string> files = {
+        {"same.txt", textContent(40000, 1)},
+        {"copy.bin", randomContent(30000, 2)},
+        {"changed.txt", changed.substr(0, 30000) + "edited" + changed.substr(30000)},
+        {"new.txt", textContent(10000, 4)},
+    };
+    {
+        RDXWriter writer(f.dir / "base.rdx");
+        f.add(writer, "same.txt", files["same.txt"]);
+        f.add(writer, "moved.bin", files["copy.bin"]);
+        f.add(writer, "changed.txt", changed);
+        writer.finalize();
+    }
+    {
+        RDXWriter writer(f.dir / "delta.rdx");
+        writer.setDeltaBase(f.dir / "base.rdx", f.decompressor);
+        for (const auto& [name, content] : files) {
+            f.add(writer, name, content);
+        }
+        writer.finalize();
+    }
+    
+    RDXReader reader(f.dir / "delta.rdx");
+    std::vector<RDXEntry> entries;
+    reader.listEntries(entries);
+    EXPECT_TRUE(reader.isDelta());
+    EXPECT_EQ(entryNamed(entries, "same.txt").kind, RDXEntryKind::BaseReference);
+    EXPECT_EQ(entryNamed(entries, "copy.bin").kind, RDXEntryKind::BaseReference);
+    EXPECT_EQ(entryNamed(entries, "copy.bin").baseFileName, "moved.bin");
+    EXPECT_EQ(entryNamed(entries, "changed.txt").kind, RDXEntryKind::BaseDelta);
+    EXPECT_EQ(entryNamed(entries, "new.txt").kind, RDXEntryKind::Block);
+    
+    f.expectContents(f.dir / "delta.rdx", files);
+    for (const auto& entry : entries) {
+        ByteBuffer content;
+        reader.readEntryContent(entry, f.decompressor, content);
+        EXPECT_EQ(std::string(reinterpret_cast<const char*>(content.data().data()), content.size()),
+                  files[entry.fileName]);
+    }
+    EXPECT_TRUE(reader.verifyArchive(f.decompressor, 2).ok());
+}
+
+TEST(DeltaArchive, DuplicateBaseNamesResolveToTheRecordedEntry) {
+    ArchiveFixture f;
+    std::string older = textContent(20000, 1);
+    std::string newer = textContent(20000, 2);
+    {
+        RDXWriter writer(f.dir / "base.rdx");
+        f.add(writer, "f.txt", older);
+        f.add(writer, "f.txt", newer);
+        writer.finalize();
+    }
+    // Restores the older version, which the base index only finds by position
+    {
+        RDXWriter writer(f.dir / "delta.rdx");
+        writer.setDeltaBase(f.dir / "base.rdx", f.decompressor);
+        f.add(writer, "f.txt", older);
+        f.add(writer, "g.txt", newer + "appended");
+        writer.finalize();
+    }
+    
+    RDXReader reader(f.dir / "delta.rdx");
+    std::vector<RDXEntry> entries;
+    reader.listEntries(entries);
+    const RDXEntry& reference = entryNamed(entries, "f.txt");
+    ASSERT_EQ(reference.kind, RDXEntryKind::BaseReference);
+    EXPECT_EQ(reference.baseEntryIndex, 0u);
+    EXPECT_EQ(f.extract(reader, reference), older);
+    EXPECT_EQ(f.extract(reader, entryNamed(entries, "g.txt")), newer + "appended");
+    EXPECT_TRUE(reader.verifyArchive(f.decompressor).ok());
+    
+    // Wrong position or wrong checksum
+    RDXEntry moved = reference;
+    moved.baseEntryIndex = 1;
+    EXPECT_THROW(f.extract(reader, moved), std::runtime_error);
+    RDXEntry tampered = reference;
+    tampered.baseContentChecksum ^= 1;
+    EXPECT_THROW(f.extract(reader, tampered), std::runtime_error);
+}
+
+TEST(StreamingExtraction, ContentEndingOnWindowBoundaries) {
+    ArchiveFixture f;
+    constexpr std::size_t window = 1024 * 1024;
+    std::map<std::string, std::string> files = {
+        {"one-window.bin", randomContent(window, 1)},
+        {"two-windows.bin", randomContent(2 * window, 2)},
+        {"short.bin", randomContent(window - 1, 3)},
+        {"long.bin", randomContent(window + 1, 4)},
+        // Zero extents are not stored, so the packed content is two windows
+        {"sparse.bin", randomContent(window, 5) + std::string(window, '\0') + randomContent(window, 6)},
+    };
+    auto archive = f.dir / "a.rdx";
+    {
+        RDXWriter writer(archive);
+        for (const auto& [name, content] : files) {
+            f.add(writer, name, content);
+        }
+        writer.finalize();
+    }
+    f.expectContents(archive, files);
+    
+    RDXReader reader(archive);
+    std::vector<RDXEntry> entries;
+    reader.listEntries(entries);
+    EXPECT_FALSE(entryNamed(entries, "sparse.bin").zeroExtents.empty());
+    
+    auto results = reader.extractMany(entries, f.dir / "many", f.decompressor, 2);
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        EXPECT_TRUE(results[i].success);
+        EXPECT_EQ(readFile(f.dir / ("many/" + entries[i].fileName)), files[entries[i].fileName]);
+    }
+    
+    for (const auto& entry : entries) {
+        auto stream = reader.openEntryStream(entry, f.decompressor);
+        std::string content;
+        std::vector<std::byte> chunk(window);
+        while (std::size_t count = stream->read(chunk)) {
+            content.append(reinterpret_cast<const char*>(chunk.data()), count);
+        }
+        EXPECT_EQ(content, files[entry.fileName]);
+    }
+    EXPECT_TRUE(reader.verifyArchive(f.decompressor, 2).ok());
+}
+
+TEST(StreamingExtraction, ChecksCompressedInputReadInChunks) {
+    ArchiveFixture f;
+    // Incompressible, so the residual stream spans many read chunks
+    std::string content = randomContent(3 * 1024 * 1024, 1);
+    auto archive = f.dir / "a.rdx";
+    {
+        RDXWriter writer(archive);
+        f.add(writer, "big.bin", content);
+    }
+    
+    std::vector<RDXEntry> entries;
+    RDXReader(archive).listEntries(entries);
+    RDXEntry entry = entries.at(0);
+    ASSERT_GT(entry.compressedStructSize, 0);
+    EXPECT_EQ(f.extract(RDXReader(archive), entry), content);
+    
+    // The decoder never looks at the structural stream; only the stream
+    // checksum covers it
+    std::int64_t headerSize = RDXReader(archive).readBlockHeader(entry).headerSize;
+    corruptByte(archive, entry.offset + headerSize);
+    RDXReader reader(archive);
+    EXPECT_THROW(reader.extractEntry(entry, f.dir / "out.bin", f.decompressor), std::runtime_error);
+}
+
+TEST(StreamingExtraction, SinksAndCallerBuffersReceiveTheContent) {
+    ArchiveFixture f;
+    std::map<std::string, std::string> files = {
+        {"text.txt", textContent(3 * 1024 * 1024, 1)},
+        {"sparse.bin", randomContent(100000, 2) + std::string(300000, '\0') + randomContent(5000, 3)},
+        {"empty.txt", ""},
+    };
+    auto archive = f.dir / "a.rdx";
+    {
+        RDXWriter writer(archive);
+        for (const auto& [name, content] : files) {
+            f.add(writer, name, content);
+        }
+    }
+    
+    RDXReader reader(archive);
+    std::vector<RDXEntry> entries;
+    reader.listEntries(entries);
+    EXPECT_FALSE(entryNamed(entries, "sparse.bin").zeroExtents.empty());
+    
+    for (const auto& entry : entries) {
+        const std::string& expected = files[entry.fileName];
+        ByteBuffer structStream;
+        ByteBuffer residualStream;
+        reader.readBlock(entry, structStream, residualStream);
+        
+        std::string sunk;
+        f.decompressor.decompressToSink(entry, structStream.data(), residualStream.data(),
+                                        [&](std::span<const std::byte> bytes) {
+            sunk.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        });
+        EXPECT_EQ(sunk, expected);
+        
+        // Exactly the original size is enough; one byte less is rejected
+        std::vector<std::byte> exact(expected.size());
+        EXPECT_EQ(f.decompressor.decompressInto(entry, structStream.data(), residualStream.data(), exact),
+                  expected.size());
+        EXPECT_EQ(std::string(reinterpret_cast<const char*>(exact.data()), exact.size()), expected);
+        if (!expected.empty()) {
+            std::vector<std::byte> undersized(expected.size() - 1);
+            EXPECT_THROW(f.decompressor.decompressInto(entry, structStream.data(), residualStream.data(), undersized),
+                         std::runtime_error);
+        }
+    }
+}
+
+TEST(ParallelFor, NestedLoopsShareTheOuterThreads) {
+    EXPECT_GE(resolveThreadCount(0), 1u);
+    EXPECT_EQ(resolveThreadCount(3), 3u);
+    
+    std::atomic<unsigned> nestedMax{0};
+    parallelFor(8, 2, [&](std::size_t) {
+        unsigned nested = resolveThreadCount(0);
+        unsigned seen = nestedMax.load();
+        while (nested > seen && !nestedMax.compare_exchange_weak(seen, nested)) {
+        }
+        EXPECT_EQ(resolveThreadCount(3), 3u);
+    });
+    EXPECT_EQ(nestedMax.load(), 1u);
+    EXPECT_EQ(resolveThreadCount(0), std::max(1u, std::thread::hardware_concurrency()));
+}
+
+TEST(MultiFrameEntries, DecodeAcrossFrameBoundaries) {
+    ArchiveFixture f;
+    constexpr std::size_t frame = 16 * 1024 * 1024;
+    std::map<std::string, std::string> files = {
+        {"one-frame.log", textContent(frame, 1)},
+        {"two-frames.log", textContent(frame + 1, 2)},
+        {"three-frames.log", textContent(2 * frame + 12345, 3)},
+    };
+    auto archive = f.dir / "a.rdx";
+    {
+        RDXWriter writer(archive);
+        for (const auto& [name, content] : files) {
+            f.add(writer, name, content);
+        }
+        writer.finalize();
+    }
+    f.expectContents(archive, files);
+    
+    RDXReader reader(archive);
+    std::vector<RDXEntry> entries;
+    reader.listEntries(entries);
+    auto results = reader.extractMany(entries, f.dir / "many", f.decompressor, 2);
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        EXPECT_TRUE(results[i].success);
+        EXPECT_EQ(readFile(f.dir / ("many/" + entries[i].fileName)), files[entries[i].fileName]);
+        
+        ByteBuffer content;
+        reader.readEntryContent(entries[i], f.decompressor, content);
+        EXPECT_EQ(std::string(reinterpret_cast<const char*>(content.data().data()), content.size()),
+                  files[entries[i].fileName]);
+    }
+    EXPECT_TRUE(reader.verifyArchive(f.decompressor, 2).ok());
+}
+
+TEST(Catalog, DescribesEntriesWithoutTheLCM) {
+    ArchiveFixture f;
+    auto archive = f.dir / "a.rdx";
+    {
+        RDXWriter writer(archive);
+        f.add(writer, "log.txt", textContent(5000, 1));
+        f.add(writer, "data.json", "{\"id\": 1, \"name\": \"first\"}\n");
+        writer.finalize();
+    }
+    
+    RDXReader reader(archive);
+    std::vector<RDXEntry> entries;
+    reader.listEntries(entries);
+    const RDXCatalog& catalog = reader.getCatalog();
+    for (const auto& entry : entries) {
+        ASSERT_TRUE(catalog.fileTypes.contains(entry.fileTypeId));
+        EXPECT_EQ(catalog.fileTypes.at(entry.fileTypeId), f.lcm.getFileTypeName(entry.fileTypeId));
+        ASSERT_TRUE(catalog.schemas.contains(entry.schemaId));
+        const SchemaDefinition& schema = f.registry.getSchemaById(entry.schemaId);
+        EXPECT_EQ(catalog.schemas.at(entry.schemaId).name, schema.name);
+        EXPECT_EQ(catalog.schemas.at(entry.schemaId).version, schema.version);
+    }
+}
+
+TEST(Catalog, ConflictingRecordsAreRejected) {
+    RDXCatalog catalog;
+    catalog.fileTypes[1] = "text";
+    catalog.schemas[2] = RDXSchemaRecord{"log", 1, "{}"};
+    
+    RDXCatalog same = catalog;
+    same.schemas[2].definition = "{ }";
+    same.fileTypes[3] = "json";
+    EXPECT_NO_THROW(catalog.merge(same));
+    EXPECT_EQ(catalog.fileTypes.size(), 2u);
+    
+    RDXCatalog otherType;
+    otherType.fileTypes[1] = "csv";
+    EXPECT_THROW(catalog.merge(otherType), std::runtime_error);
+    RDXCatalog otherSchema;
+    otherSchema.fileTypes[4] = "xml";
+    otherSchema.schemas[2] = RDXSchemaRecord{"log", 2, "{}"};
+    EXPECT_THROW(catalog.merge(otherSchema), std::runtime_error);
+    EXPECT_FALSE(catalog.fileTypes.contains(4));
+}
+
+TEST(Catalog, MergeRejectsArchivesFromDifferentLCMs) {
+    ArchiveFixture f;
+    {
+        RDXWriter writer(f.dir / "a.rdx");
+        f.add(writer, "one.txt", textContent(3000, 1));
+        writer.finalize();
+    }
+    RDXReader first(f.dir / "a.rdx");
+    RDXEntry entry = *first.findEntry("one.txt");
+    
+    // Same block, but cataloged under a different file type name for its ID
+    {
+        RDXWriter writer(f.dir / "b.rdx");
+        RDXCatalog foreign;
+        foreign.fileTypes[entry.fileTypeId] = "not-" + first.getCatalog().fileTypes.at(entry.fileTypeId);
+        foreign.schemas = first.getCatalog().schemas;
+        writer.addCatalog(foreign);
+        ByteBuffer block;
+        first.readRawBlock(entry, block);
+        writer.addRawBlock(entry, block.data(), "two.txt");
+        writer.finalize();
+    }
+    RDXReader second(f.dir / "b.rdx");
+    
+    RDXWriter merged(f.dir / "merged.rdx");
+    EXPECT_THROW(mergeArchives({&first, &second}, merged), std::runtime_error);
+    
+    // Adding files compressed with this LCM to the foreign archive fails too,
+    // before anything is written
+    {
+        RDXWriter writer(f.dir / "b.rdx", RDXOpenMode::Append);
+        EXPECT_THROW(f.add(writer, "three.txt", textContent(3000, 3)), std::runtime_error);
+        EXPECT_EQ(writer.getEntries().size(), 1u);
+        writer.finalize();
+    }
+    EXPECT_TRUE(RDXReader(f.dir / "b.rdx").verifyArchive(f.decompressor).ok());
+}
@@ -0,0 +1,53 @@
+#include "TestSupport.h"
+#include "lcm/LCMManager.h"
+#include "schemas/SchemaRegistry.h"
+#include <string>
+
+using namespace rdx::core;
+using rdx::test::TempDir;
+
+TEST(SchemaRegistry, ProvidesBuiltinSchemas) {
+    TempDir dir;
+    LCMManager lcm(dir / "lcm.db");
+    SchemaRegistry registry(lcm);
+    
+    const auto& json = registry.getSchemaById(SchemaRegistry::SCHEMA_JSON_GENERIC_ID);
+    EXPECT_EQ(json.schemaId, SchemaRegistry::SCHEMA_JSON_GENERIC_ID);
+    EXPECT_EQ(registry.getSchemaId(json.name, json.version), SchemaRegistry::SCHEMA_JSON_GENERIC_ID);
+    EXPECT_GE(registry.listAllSchemas().size(), 7u);
+    EXPECT_EQ(registry.getSchemaId("no-such-schema", 1), -1);
+}
+
+TEST(SchemaRegistry, MapsFileTypesToDefaultSchemas) {
+    TempDir dir;
+    LCMManager lcm(dir / "lcm.db");
+    SchemaRegistry registry(lcm);
+    
+    int jsonType = lcm.getOrCreateFileTypeId("json", "json");
+    int csvType = lcm.getOrCreateFileTypeId("csv_simple", "csv");
+    EXPECT_EQ(registry.getDefaultSchemaForFileType(jsonType).schemaId,
+              SchemaRegistry::SCHEMA_JSON_GENERIC_ID);
+    EXPECT_EQ(registry.getDefaultSchemaForFileType(csvType).schemaId,
+              SchemaRegistry::SCHEMA_CSV_SIMPLE_ID);
+}
+
+TEST(SchemaRegistry, RegistriesOnOneDatabaseAgree) {
+    TempDir dir;
+    
+    // Both managers open (and warm their caches) before any schema exists
+    LCMManager first(dir / "lcm.db");
+    LCMManager second(dir / "lcm.db");
+    SchemaRegistry firstRegistry(first);
+    SchemaRegistry secondRegistry(second);
+    
+    // The second registry finds the rows the first one inserted
+    for (const auto& schema : firstRegistry.listAllSchemas()) {
+        EXPECT_EQ(secondRegistry.getSchemaId(schema.name, schema.version), schema.schemaId);
+    }
+    EXPECT_EQ(secondRegistry.listAllSchemas().size(), firstRegistry.listAllSchemas().size());
+    
+    // A file type created through one manager maps the same way through the other
+    int csvType = second.getOrCreateFileTypeId("csv_simple", "csv");
+    EXPECT_EQ(first.getOrCreateFileTypeId("csv_simple", "csv"), csvType);
+    EXPECT_EQ(firstRegistry.getDefaultSchemaForFileType(csvType).schemaId, SchemaRegistry::SCHEMA_CSV_SIMPLE_ID);
+}
@@ -0,0 +1,132 @@
+#include "TestSupport.h"
+#include "compression/CompressionEngine.h"
+#include "container/RDXReader.h"
+#include "container/RDXWriter.h"
+#include "decompression/DecompressionEngine.h"
+#include "lcm/LCMManager.h"
+#include "lcm/LCMWriteQueue.h"
+#include "schemas/SchemaRegistry.h"
+#include "util/HashUtils.h"
+#include <map>
+#include <memory>
+#include <string>
+
+using namespace rdx::core;
+using rdx::test::TempDir;
+using rdx::test::randomContent;
+using rdx::test::readFile;
+using rdx::test::textContent;
+using rdx::test::writeFile;
+
+namespace {
+
+// Input files of several kinds, keyed by their path below the input directory
+std::map<std::string, std::string> makeCorpus(unsigned seed) {
+    return {
+        {"logs/app.log", textContent(200000, seed)},
+        {"logs/empty.log", ""},
+        {"config/settings.ini", "[main]\nname = rdx\nthreads = 4\n"},
+        {"data/records.json", "{\"id\": " + std::to_string(seed) + ", \"values\": [1, 2, 3]}\n"},
+        {"data/blob.bin", randomContent(150000, seed)},
+    };
+}
+
+void writeCorpus(const std::filesystem::path& root, const std::map<std::string, std::string>& corpus) {
+    for (const auto& [name, content] : corpus) {
+        writeFile(root / name, content);
+    }
+}
+
+void expectExtracted(const std::filesystem::path& root, const std::map<std::string, std::string>& corpus) {
+    for (const auto& [name, content] : corpus) {
+        EXPECT_EQ(readFile(root / name), content);
+    }
+}
+
+} // namespace
+
+TEST(EndToEnd, CompressAppendAndExtractAll) {
+    TempDir dir;
+    LCMManager lcm(dir / "lcm.db");
+    SchemaRegistry registry(lcm);
+    CompressionEngine compressor(lcm, registry);
+    DecompressionEngine decompressor;
+    
+    auto first = makeCorpus(1);
+    writeCorpus(dir / "in", first);
+    auto archive = dir / "corpus.rdx";
+    {
+        RDXWriter writer(archive);
+        for (const auto& [name, content] : first) {
+            writer.addFile(dir / ("in/" + name), compressor, name);
+        }
+        writer.finalize();
+    }
+    
+    // A new file, and a new version of one already archived
+    std::map<std::string, std::string> second = {
+        {"later/notes.txt", textContent(5000, 9)},
+        {"logs/app.log", textContent(250000, 10)},
+    };
+    writeCorpus(dir / "in", second);
+    {
+        RDXWriter writer(archive, RDXOpenMode::Append);
+        for (const auto& [name, content] : second) {
+            writer.addFile(dir / ("in/" + name), compressor, name);
+        }
+        writer.finalize();
+    }
+    
+    RDXReader reader(archive);
+    auto results = reader.extractAll(dir / "out", decompressor);
+    ASSERT_EQ(results.size(), first.size() + second.size());
+    std::size_t superseded = 0;
+    for (const auto& result : results) {
+        EXPECT_TRUE(result.success);
+        superseded += result.superseded ? 1 : 0;
+    }
+    EXPECT_EQ(superseded, 1u);
+    
+    // Later versions win
+    first.erase("logs/app.log");
+    expectExtracted(dir / "out", first);
+    expectExtracted(dir / "out", second);
+}
+
+TEST(EndToEnd, QueuedLCMUpdatesMatchDirectOnes) {
+    TempDir dir;
+    auto corpus = makeCorpus(3);
+    writeCorpus(dir / "in", corpus);
+    
+    // The same corpus through the write-behind queue and without it
+    for (bool queued : {false, true}) {
+        std::string tag = queued ? "queued" : "direct";
+        LCMManager lcm(dir / (tag + ".db"));
+        SchemaRegistry registry(lcm);
+        CompressionEngine compressor(lcm, registry);
+        if (queued) {
+            compressor.setWriteQueue(std::make_shared<LCMWriteQueue>(lcm, 4));
+        }
+        {
+            RDXWriter writer(dir / (tag + ".rdx"));
+            for (const auto& [name, content] : corpus) {
+                writer.addFile(dir / ("in/" + name), compressor, name);
+            }
+            writer.finalize();
+        }
+        
+        // finalize() waits for the queue, so everything is recorded by now
+        EXPECT_EQ(lcm.getTotalFilesTracked(), static_cast<std::int64_t>(corpus.size()));
+        for (const auto& [name, content] : corpus) {
+            std::span<const std::byte> bytes(reinterpret_cast<const std::byte*>(content.data()), content.size());
+            EXPECT_TRUE(lcm.findFileByContentHash(computeContentHash(bytes)).has_value());
+        }
+        
+        // One schema use per recorded file
+        std::int64_t uses = 0;
+        for (const auto& [schemaId, count] : lcm.getTopSchemasByUsage(100)) {
+            uses += count;
+        }
+        EXPECT_EQ(uses, static_cast<std::int64_t>(corpus.size()));
+    }
+}